@@ -30,6 +30,7 @@
 #include "processor/integrator.h"
 #include "protobuf/geometry.h"
 #include "simulator/simulator.h"
+#include "simulator/fastsimulator.h"
 #include "strategy/script/debughelper.h"
 #include "strategy/strategyreplayhelper.h"
 #include "strategy/strategy.h"
@@ -37,6 +38,7 @@
 #include "seshat/seshat.h"
 #include <QMetaType>
 #include <QThread>
+#include <QTimer>
 #include <QList>
 
 using namespace camun::simulator;
@@ -48,6 +50,9 @@ using namespace camun::simulator;
  *
  * Creates a processor thread, a simulator thread, a networking thread and two
  * strategy threads.
+ *
+ * In lockstep mode simulator, processor and strategies stay in the thread of
+ * Amun and are driven by \ref runLockstep as fast as possible, without any timers.
  */
 
 /*!
@@ -58,9 +63,10 @@ using namespace camun::simulator;
 /*!
  * \brief Creates an Amun instance
  * \param simulatorOnly Only enable the simulator (for amun-cli + unittests)
+ * \param lockstep Run simulator, processor and strategies in lockstep, requires simulatorOnly
  * \param parent Parent object
  */
-Amun::Amun(bool simulatorOnly, QObject *parent) :
+Amun::Amun(bool simulatorOnly, bool lockstep, QObject *parent) :
     QObject(parent),
     m_processor(nullptr),
     m_transceiver(nullptr),
@@ -73,6 +79,7 @@ Amun::Amun(bool simulatorOnly, QObject *parent) :
     m_scaling(1.0f),
     m_useNetworkTransceiver(false),
     m_simulatorOnly(simulatorOnly),
+    m_lockstep(simulatorOnly && lockstep),
     m_useInternalReferee(true),
     m_useAutoref(true),
     m_networkInterfaceWatcher(nullptr),
@@ -109,6 +116,10 @@ Amun::Amun(bool simulatorOnly, QObject *parent) :
 
     m_commandConverter = new CommandConverter(m_timer, this);
     connect(m_commandConverter, &CommandConverter::sendStatus, this, &Amun::handleStatus);
+    if (m_lockstep) {
+        // statuses are produced much faster than in real time, see runLockstep
+        connect(this, &Amun::sendStatus, this, [this]() { m_pendingStatuses.fetchAndAddRelaxed(1); }, Qt::DirectConnection);
+    }
     // these threads just run an event loop
     // using the signal-slot mechanism the objects in these can be called
     m_processorThread = new QThread(this);
@@ -145,8 +156,14 @@ void Amun::start()
     // create processor
     Q_ASSERT(m_processor == nullptr);
     m_processor = new Processor(m_timer, false);
-    m_processor->moveToThread(m_processorThread);
-    connect(m_processorThread, SIGNAL(finished()), m_processor, SLOT(deleteLater()));
+    if (m_lockstep) {
+        m_processor->moveToThread(thread());
+        // only runLockstep advances the time, this also stops the trigger of the processor
+        m_timer->setScaling(0);
+    } else {
+        m_processor->moveToThread(m_processorThread);
+        connect(m_processorThread, SIGNAL(finished()), m_processor, SLOT(deleteLater()));
+    }
 
     // route commands and replay status to processor and integrator
     connect(this, SIGNAL(gotCommand(Command)), m_processor, SLOT(handleCommand(Command)));
@@ -182,14 +199,19 @@ void Amun::start()
         connect(m_debugHelperThread, SIGNAL(finished()), m_debugHelper[i], SLOT(deleteLater()));
 
         m_gameControllerConnection[i].reset(new GameControllerConnection(m_processor->getInternalGameController(), i == 2));
-        m_gameControllerConnection[i]->moveToThread(m_strategyThread[i]);
+        m_gameControllerConnection[i]->moveToThread(m_lockstep ? thread() : m_strategyThread[i]);
         connect(this, &Amun::gotRefereeHost, m_gameControllerConnection[i].get(), &GameControllerConnection::handleRefereeHost);
         connect(this, &Amun::useInternalGameController, m_gameControllerConnection[i].get(), &GameControllerConnection::switchInternalGameController);
 
         Q_ASSERT(m_strategy[i] == nullptr);
         m_strategy[i] = new Strategy(m_timer, strategy, m_debugHelper[i], &m_compilerRegistry, m_gameControllerConnection[i], i == 2, false, m_pathInputSaver);
-        m_strategy[i]->moveToThread(m_strategyThread[i]);
-        connect(m_strategyThread[i], SIGNAL(finished()), m_strategy[i], SLOT(deleteLater()));
+        if (m_lockstep) {
+            m_strategy[i]->moveToThread(thread());
+            m_strategy[i]->setManualTrigger(true);
+        } else {
+            m_strategy[i]->moveToThread(m_strategyThread[i]);
+            connect(m_strategyThread[i], SIGNAL(finished()), m_strategy[i], SLOT(deleteLater()));
+        }
 
         // send tracking, geometry and referee to strategy
         connect(m_processor, SIGNAL(sendStrategyStatus(Status)), m_strategy[i], SLOT(handleStatus(Status)));
@@ -309,6 +331,15 @@ void Amun::start()
  */
 void Amun::stop()
 {
+    if (m_lockstep) {
+        // not owned by a worker thread, the strategies may still write to their debug helpers
+        for (int i = 0; i < 3; i++) {
+            delete m_strategy[i];
+        }
+        delete m_simulator;
+        delete m_processor;
+    }
+
     // stop threads
     m_processorThread->quit();
     m_transceiverThread->quit();
@@ -368,9 +399,13 @@ void Amun::setupReceiver(Receiver *&receiver, const QHostAddress &address, quint
 
 void Amun::createSimulator(const amun::SimulatorSetup &setup)
 {
-    m_simulator = new Simulator(m_timer, setup);
-    m_simulator->moveToThread(m_simulatorThread);
-    connect(m_simulatorThread, SIGNAL(finished()), m_simulator, SLOT(deleteLater()));
+    m_simulator = new Simulator(m_timer, setup, m_lockstep);
+    if (m_lockstep) {
+        m_simulator->moveToThread(thread());
+    } else {
+        m_simulator->moveToThread(m_simulatorThread);
+        connect(m_simulatorThread, SIGNAL(finished()), m_simulator, SLOT(deleteLater()));
+    }
     // pass on simulator and team settings
     connect(this, SIGNAL(gotCommand(Command)), m_simulator, SLOT(handleCommand(Command)));
     // pass simulator timing
@@ -409,6 +444,9 @@ void Amun::handleCommandLocally(const Command &command)
             m_simulator->blockSignals(true);
             m_simulator->deleteLater();
             m_timer->reset();
+            if (m_lockstep) {
+                m_timer->setScaling(0);
+            }
             createSimulator(sim.simulator_setup());
             setSimulatorEnabled(m_simulatorEnabled, m_useNetworkTransceiver);
         }
@@ -543,13 +581,63 @@ void Amun::enableAutoref(bool enable)
  */
 void Amun::updateScaling(float scaling)
 {
-    m_timer->setScaling(scaling);
+    // the time only advances in runLockstep, which stops while the simulator is paused
+    m_timer->setScaling(m_lockstep ? 0 : scaling);
+    if (m_lockstep) {
+        scheduleLockstep();
+    }
 
     Status status(new amun::Status);
     status->set_timer_scaling(scaling);
     handleStatus(status);
 }
 
+void Amun::scheduleLockstep()
+{
+    if (!m_lockstepScheduled) {
+        m_lockstepScheduled = true;
+        QTimer::singleShot(0, this, &Amun::runLockstep);
+    }
+}
+
+/*!
+ * \brief Runs a few processor ticks of simulator, processor and strategies in lockstep
+ *
+ * Returns to the event loop afterwards to handle incoming commands.
+ */
+void Amun::runLockstep()
+{
+    m_lockstepScheduled = false;
+    // restarted by updateScaling
+    if (!m_simulatorEnabled || m_scaling <= 0) {
+        m_processor->setExternallyTriggered(false);
+        return;
+    }
+    // the receiver of the statuses may be slower than the simulation, e.g. while recording a log
+    // wait for it instead of letting its event queue grow without bound
+    if (m_pendingStatuses.loadAcquire() > MAX_PENDING_STATUSES) {
+        m_lockstepScheduled = true;
+        QTimer::singleShot(1, this, &Amun::runLockstep);
+        return;
+    }
+    m_processor->setExternallyTriggered(true);
+
+    const int ticksPerIteration = 10;
+    const qint64 tickDuration = 1000000000 / Processor::FREQUENCY;
+    const bool runAutoref = m_useInternalReferee && m_useAutoref;
+    for (int tick = 0; tick < ticksPerIteration; tick++) {
+        FastSimulator::goDelta(m_simulator, m_timer, tickDuration);
+        m_processor->process();
+        // the strategies send their commands directly to the processor
+        for (int i = 0; i < 3; i++) {
+            if (i < 2 || runAutoref) {
+                m_strategy[i]->tryProcess();
+            }
+        }
+    }
+    scheduleLockstep();
+}
+
 /*!
  * \brief Add timestamp and emit \ref sendStatus
  * \param status Status to send
@@ -34,19 +34,28 @@ AmunClient::~AmunClient()
     stop();
 }
 
-void AmunClient::start(bool simulatorOnly)
+void AmunClient::start(bool simulatorOnly, bool lockstep)
 {
     m_amunThread = new QThread(this);
-    m_amun = new Amun(simulatorOnly);
+    m_amun = new Amun(simulatorOnly, lockstep);
     m_amun->moveToThread(m_amunThread);
     connect(m_amunThread, SIGNAL(finished()), m_amun, SLOT(deleteLater()));
 
-    connect(m_amun, SIGNAL(sendStatus(Status)), SIGNAL(gotStatus(Status)));
+    connect(m_amun, &Amun::sendStatus, this, &AmunClient::handleStatus);
     connect(this, SIGNAL(sendCommand(Command)), m_amun, SLOT(handleCommand(Command)));
     m_amun->start();
     m_amunThread->start();
 }
 
+void AmunClient::handleStatus(const Status &status)
+{
+    emit gotStatus(status);
+    // the receivers have handled the status, unless they queued it once again
+    if (m_amun) {
+        m_amun->acknowledgeStatus();
+    }
+}
+
 void AmunClient::stop()
 {
     m_amunThread->quit();
@@ -25,6 +25,7 @@
 #include "gamecontroller/gamecontrollerconnection.h"
 #include "protobuf/command.h"
 #include "protobuf/status.h"
+#include <QAtomicInt>
 #include <QObject>
 #include <QSet>
 #include <memory>
@@ -56,7 +57,7 @@ class Amun : public QObject
     Q_OBJECT
 
 public:
-    explicit Amun(bool simulatorOnly, QObject *parent = 0);
+    explicit Amun(bool simulatorOnly, bool lockstep = false, QObject *parent = 0);
     ~Amun() override;
     Amun(const Amun&) = delete;
     Amun& operator=(const Amun&) = delete;
@@ -73,6 +74,10 @@ signals:
 public:
     void start();
     void stop();
+    // in lockstep mode the simulation waits while more statuses than this are not acknowledged
+    static const int MAX_PENDING_STATUSES = 1000;
+    // has to be called once for every status received via sendStatus, thread-safe
+    void acknowledgeStatus() { m_pendingStatuses.fetchAndAddRelaxed(-1); }
 
 public slots:
     void handleCommand(const Command &command);
@@ -83,6 +88,7 @@ private slots:
     void handleRefereePacket(QByteArray, qint64, QString host);
     void handleStatusForReplay(const Status &status);
     void handleCommandLocally(const Command& command);
+    void runLockstep();
 
 private:
     void setupReceiver(Receiver *&receiver, const QHostAddress &address, quint16 port);
@@ -92,6 +98,7 @@ private:
     void enableAutoref(bool enable);
     void pauseSimulator(const amun::PauseSimulatorCommand &pauseCommand);
     void enableTrackingReplay();
+    void scheduleLockstep();
 
 private:
     QThread *m_processorThread;
@@ -123,6 +130,10 @@ private:
     float m_scaling;
     bool m_useNetworkTransceiver;
     const bool m_simulatorOnly;
+    const bool m_lockstep;
+    bool m_lockstepScheduled = false;
+    // statuses sent in lockstep mode that were not acknowledged yet
+    QAtomicInt m_pendingStatuses;
     bool m_useInternalReferee;
     bool m_useAutoref;
     bool m_trackingReplay = false;
@@ -43,9 +43,13 @@ signals:
     void sendCommand(const Command &command);
 
 public:
-    void start(bool simulatorOnly = false);
+    // lockstep runs the simulation as fast as possible, see Amun
+    void start(bool simulatorOnly = false, bool lockstep = false);
     void stop();
 
+private slots:
+    void handleStatus(const Status &status);
+
 private:
     Amun* m_amun;
     QThread *m_amunThread;
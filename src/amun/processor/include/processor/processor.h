@@ -50,6 +50,9 @@ public:
     Processor& operator=(const Processor&) = delete;
     bool getIsFlipped() const { return m_lastFlipped; }
     InternalGameController *getInternalGameController() const { return m_internalGameController; }
+    // for a processor that is driven by calls to process instead of its own timer (see Amun::runLockstep)
+    // tells whether these calls currently happen
+    void setExternallyTriggered(bool running) { m_externallyTriggered = running; }
 
 signals:
     void sendStatus(const Status &status);
@@ -107,6 +110,7 @@ private:
     bool m_mixedTeamInfoSet;
     bool m_refereeInternalActive;
     bool m_simulatorEnabled;
+    bool m_externallyTriggered = false;
     bool m_lastFlipped;
 
     InternalGameController *m_internalGameController;
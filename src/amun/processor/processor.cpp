@@ -357,7 +357,8 @@ void Processor::handleRefereePacket(const QByteArray &data, qint64 /*time*/)
 {
     m_referee->handlePacket(data);
     // ensure that tournament mode works even if the simulator is stopped
-    if (m_referee->isGameRunning() && m_simulatorEnabled && !m_trigger->isActive()) {
+    const bool isProcessing = m_trigger->isActive() || m_externallyTriggered;
+    if (m_referee->isGameRunning() && m_simulatorEnabled && !isProcessing) {
         Status status = Status(new amun::Status);
         status->mutable_game_state()->set_is_real_game_running(true);
         emit sendStatus(status);
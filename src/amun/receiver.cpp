@@ -24,6 +24,20 @@
 #include <QNetworkProxy>
 #include <QUdpSocket>
 
+#ifdef Q_OS_LINUX
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+// large enough for every udp datagram
+static const int MAX_DATAGRAM_SIZE = 65536;
+#ifdef Q_OS_LINUX
+// datagrams read with a single recvmmsg call
+static const int RECEIVE_BATCH_SIZE = 16;
+#endif
+
 /*!
  * \class Receiver
  * \ingroup amun
@@ -51,7 +65,13 @@ Receiver::Receiver(const QHostAddress &groupAddress, quint16 port, Timer *timer)
     m_port(port),
     m_socket(nullptr),
     m_timer(timer)
-{ }
+{
+#ifdef Q_OS_LINUX
+    m_buffer.resize(MAX_DATAGRAM_SIZE * RECEIVE_BATCH_SIZE);
+#else
+    m_buffer.resize(MAX_DATAGRAM_SIZE);
+#endif
+}
 
 /*!
  * \brief Destructor
@@ -137,15 +157,54 @@ void Receiver::updatePort(quint16 port)
 }
 
 /*!
- * \brief Read a packet from the socket and emit \ref gotPacket
+ * \brief Read all pending packets from the socket and emit \ref gotPacket for each
  */
 void Receiver::readData()
 {
     while (m_socket->hasPendingDatagrams()) {
-        QByteArray data;
-        data.resize(m_socket->pendingDatagramSize());
+        const qint64 time = m_timer->currentTime();
+        // the first datagram is always read by the socket itself, this keeps its read notification active
         QHostAddress senderAdddress;
-        m_socket->readDatagram(data.data(), data.size(), &senderAdddress);
-        emit gotPacket(data, m_timer->currentTime(), senderAdddress.toString());
+        const qint64 size = m_socket->readDatagram(m_buffer.data(), MAX_DATAGRAM_SIZE, &senderAdddress);
+        if (size < 0) {
+            return;
+        }
+        emit gotPacket(QByteArray(m_buffer.constData(), size), time, senderAdddress.toString());
+        readPendingBatched();
+    }
+}
+
+/*!
+ * \brief Read the remaining packets without a syscall per packet, if supported by the platform
+ */
+void Receiver::readPendingBatched()
+{
+#ifdef Q_OS_LINUX
+    mmsghdr messages[RECEIVE_BATCH_SIZE];
+    iovec buffers[RECEIVE_BATCH_SIZE];
+    sockaddr_storage senders[RECEIVE_BATCH_SIZE];
+    std::memset(messages, 0, sizeof(messages));
+    for (int i = 0; i < RECEIVE_BATCH_SIZE; i++) {
+        buffers[i].iov_base = m_buffer.data() + i * MAX_DATAGRAM_SIZE;
+        buffers[i].iov_len = MAX_DATAGRAM_SIZE;
+        messages[i].msg_hdr.msg_iov = &buffers[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+        messages[i].msg_hdr.msg_name = &senders[i];
     }
+
+    const int fd = m_socket->socketDescriptor();
+    int received;
+    do {
+        for (int i = 0; i < RECEIVE_BATCH_SIZE; i++) {
+            messages[i].msg_hdr.msg_namelen = sizeof(senders[i]);
+        }
+        // datagrams keep arriving while the previous ones are handled, thus the time is taken right before every read
+        const qint64 time = m_timer->currentTime();
+        received = recvmmsg(fd, messages, RECEIVE_BATCH_SIZE, MSG_DONTWAIT, nullptr);
+        for (int i = 0; i < received; i++) {
+            const QHostAddress sender(reinterpret_cast<const sockaddr*>(&senders[i]));
+            emit gotPacket(QByteArray(static_cast<const char*>(buffers[i].iov_base), messages[i].msg_len), time, sender.toString());
+        }
+    } while (received == RECEIVE_BATCH_SIZE);
+#endif
 }
@@ -22,6 +22,7 @@
 #define RECEIVER_H
 
 #include <QUdpSocket>
+#include <QVector>
 #include "protobuf/status.h"
 
 class Timer;
@@ -50,10 +51,14 @@ private slots:
     void readData();
 
 private:
+    void readPendingBatched();
+
     QHostAddress m_groupAddress;
     quint16 m_port;
     QUdpSocket *m_socket;
     Timer *m_timer;
+    // reused for every read
+    QVector<char> m_buffer;
 };
 
 #endif // RECEIVER_H
@@ -0,0 +1,128 @@
+/***************************************************************************
+ *   Copyright 2021                                                        *
+ *   Robotics Erlangen e.V.                                                *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "batchsimulator.h"
+#include "fastsimulator.h"
+#include "simulator.h"
+#include "core/parallelfor.h"
+#include "core/timer.h"
+#include <QThread>
+
+using namespace camun::simulator;
+
+/*!
+ * \class BatchSimulator
+ * \ingroup simulator
+ * \brief Runs many independent simulator worlds in parallel without an event loop
+ *
+ * Every world has its own Simulator, Timer and random seed. The simulators run in
+ * manual trigger mode and are stepped as fast as possible on a private thread pool.
+ */
+
+// the simulator requires a time different from zero
+static const qint64 WORLD_START_TIME = 1000 * 1000 * 1000;
+
+struct BatchSimulator::World
+{
+    Timer timer;
+    std::unique_ptr<Simulator> simulator;
+    WorldOutput output;
+};
+
+BatchSimulator::BatchSimulator(int threadCount)
+{
+    m_pool.setMaxThreadCount(threadCount > 0 ? threadCount : QThread::idealThreadCount());
+}
+
+BatchSimulator::~BatchSimulator()
+{
+    m_pool.waitForDone();
+}
+
+int BatchSimulator::addWorld(const amun::SimulatorSetup &setup, uint32_t seed)
+{
+    std::unique_ptr<World> world(new World);
+    World *w = world.get();
+    w->timer.setTime(WORLD_START_TIME, 0);
+    w->simulator.reset(new Simulator(&w->timer, setup, true));
+    Simulator *sim = w->simulator.get();
+    // the scaling of the timer is never changed, thus the simulator is not notified about it
+    sim->setScaling(0);
+    sim->seedPRGN(seed);
+
+    // the simulator is stepped from the worker threads, use direct connections to bypass the event loop
+    QObject::connect(sim, &Simulator::gotPacket, sim, [w](const QByteArray &data, qint64 time, const QString &) {
+        w->output.visionPackets.append(qMakePair(time, data));
+    }, Qt::DirectConnection);
+    QObject::connect(sim, &Simulator::sendRealData, sim, [w](const QByteArray &data) {
+        w->output.simulatorStates.append(data);
+    }, Qt::DirectConnection);
+    QObject::connect(sim, &Simulator::sendRadioResponses, sim, [w](const QList<robot::RadioResponse> &responses) {
+        w->output.radioResponses.append(responses);
+    }, Qt::DirectConnection);
+
+    Command command(new amun::Command);
+    command->mutable_simulator()->set_enable(true);
+    sim->handleCommand(command);
+
+    m_worlds.push_back(std::move(world));
+    return m_worlds.size() - 1;
+}
+
+qint64 BatchSimulator::currentTime(int world) const
+{
+    return m_worlds[world]->timer.currentTime();
+}
+
+void BatchSimulator::handleCommand(int world, const Command &command)
+{
+    m_worlds[world]->simulator->handleCommand(command);
+}
+
+void BatchSimulator::handleRadioCommands(int world, const SSLSimRobotControl &control, bool isBlue)
+{
+    World *w = m_worlds[world].get();
+    w->simulator->handleRadioCommands(control, isBlue, w->timer.currentTime());
+}
+
+void BatchSimulator::step(qint64 delta)
+{
+    parallelFor(m_worlds.size(), [this, delta](int i) {
+        World *w = m_worlds[i].get();
+        FastSimulator::goDelta(w->simulator.get(), &w->timer, delta);
+    }, &m_pool);
+}
+
+void BatchSimulator::step(qint64 delta, const std::function<void(int)> &callback)
+{
+    parallelFor(m_worlds.size(), [this, delta, &callback](int i) {
+        World *w = m_worlds[i].get();
+        FastSimulator::goDeltaCallback(w->simulator.get(), &w->timer, delta, [&callback, i]() {
+            callback(i);
+        });
+    }, &m_pool);
+}
+
+BatchSimulator::WorldOutput BatchSimulator::takeOutput(int world)
+{
+    WorldOutput output;
+    std::swap(output, m_worlds[world]->output);
+    return output;
+}
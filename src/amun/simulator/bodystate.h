@@ -0,0 +1,86 @@
+/***************************************************************************
+ *   Copyright 2021                                                        *
+ *   Robotics Erlangen e.V.                                                *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef BODYSTATE_H
+#define BODYSTATE_H
+
+#include <btBulletDynamicsCommon.h>
+
+namespace camun {
+    namespace simulator {
+        struct BodyState;
+    }
+}
+
+// complete dynamic state of a rigid body, used to snapshot and restore the simulator
+struct camun::simulator::BodyState
+{
+    btTransform transform;
+    btVector3 linearVelocity;
+    btVector3 angularVelocity;
+    btScalar linearDamping;
+    btScalar angularDamping;
+    int activationState;
+    btScalar deactivationTime;
+
+    // state of a freshly created body
+    static BodyState atRest(const btTransform &transform)
+    {
+        BodyState state;
+        state.transform = transform;
+        state.linearVelocity.setZero();
+        state.angularVelocity.setZero();
+        state.linearDamping = 0;
+        state.angularDamping = 0;
+        state.activationState = ACTIVE_TAG;
+        state.deactivationTime = 0;
+        return state;
+    }
+
+    void save(const btRigidBody *body)
+    {
+        transform = body->getWorldTransform();
+        linearVelocity = body->getLinearVelocity();
+        angularVelocity = body->getAngularVelocity();
+        linearDamping = body->getLinearDamping();
+        angularDamping = body->getAngularDamping();
+        activationState = body->getActivationState();
+        deactivationTime = body->getDeactivationTime();
+    }
+
+    void restore(btRigidBody *body) const
+    {
+        body->setWorldTransform(transform);
+        body->setInterpolationWorldTransform(transform);
+        if (body->getMotionState()) {
+            body->getMotionState()->setWorldTransform(transform);
+        }
+        body->setLinearVelocity(linearVelocity);
+        body->setAngularVelocity(angularVelocity);
+        body->setInterpolationLinearVelocity(linearVelocity);
+        body->setInterpolationAngularVelocity(angularVelocity);
+        body->setDamping(linearDamping, angularDamping);
+        body->clearForces();
+        body->forceActivationState(activationState);
+        body->setDeactivationTime(deactivationTime);
+    }
+};
+
+#endif // BODYSTATE_H
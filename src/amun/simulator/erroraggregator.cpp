@@ -21,17 +21,95 @@
 #include "erroraggregator.h"
 #include "simulator.h"
 #include <QList>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 
 
 using namespace camun::simulator;
 
+static_assert(static_cast<int>(ErrorSource::BLUE) == 0 && static_cast<int>(ErrorSource::CONFIG) == 2,
+              "error sources are used as buffer index");
+
+ErrorAggregator::ErrorAggregator(QObject* parent) : QObject(parent)
+{
+    for (Buffer& buffer : m_data) {
+        buffer.errors.reserve(MAX_ERRORS_PER_SOURCE);
+        buffer.counts.reserve(MAX_ERRORS_PER_SOURCE);
+        buffer.repeated.reserve(MAX_ERRORS_PER_SOURCE);
+        buffer.nextRepeated.reserve(MAX_ERRORS_PER_SOURCE);
+    }
+}
+
 void ErrorAggregator::aggregate(SSLSimError error, ErrorSource source) {
-    m_data[source].push_back(std::move(error));
+    Buffer& buffer = m_data[static_cast<int>(source)];
+
+    for (int i = 0; i < buffer.errors.size(); i++) {
+        const SSLSimError& other = buffer.errors[i];
+        if (other->code() == error->code() && other->message() == error->message()) {
+            buffer.counts[i]++;
+            return;
+        }
+    }
+
+    if (buffer.errors.size() < MAX_ERRORS_PER_SOURCE) {
+        buffer.errors.push_back(std::move(error));
+        buffer.counts.push_back(1);
+    } else {
+        buffer.errors[buffer.start] = std::move(error);
+        buffer.counts[buffer.start] = 1;
+        buffer.start = (buffer.start + 1) % MAX_ERRORS_PER_SOURCE;
+    }
+}
+
+bool ErrorAggregator::isEmpty(ErrorSource source) const {
+    return m_data[static_cast<int>(source)].errors.isEmpty();
+}
+
+void ErrorAggregator::takeAggregates(ErrorSource source, QList<SSLSimError>& errors) {
+    Buffer& buffer = m_data[static_cast<int>(source)];
+    // oldest first
+    std::rotate(buffer.errors.begin(), buffer.errors.begin() + buffer.start, buffer.errors.end());
+    std::rotate(buffer.counts.begin(), buffer.counts.begin() + buffer.start, buffer.counts.end());
+    buffer.start = 0;
+
+    for (int i = 0; i < buffer.errors.size(); i++) {
+        if (buffer.counts[i] > 1) {
+            const sslsim::SimulatorError& error = *buffer.errors[i];
+            char suffix[32];
+            const int suffixLength = std::snprintf(suffix, sizeof(suffix), " (repeated %d times)", buffer.counts[i]);
+            const auto isSameRepetition = [&error, suffix, suffixLength](const SSLSimError& other) {
+                const std::string& message = other->message();
+                return other->code() == error.code() && message.size() == error.message().size() + suffixLength
+                        && message.compare(0, error.message().size(), error.message()) == 0
+                        && std::memcmp(message.data() + error.message().size(), suffix, suffixLength) == 0;
+            };
+            auto it = std::find_if(buffer.repeated.begin(), buffer.repeated.end(), isSameRepetition);
+            // the error may still be referenced by whoever reported it, the note is only added to a copy
+            // reported copies are never modified again, as the receivers may still use them
+            SSLSimError repeated;
+            if (it != buffer.repeated.end()) {
+                repeated = *it;
+            } else {
+                repeated.reset(new sslsim::SimulatorError(error));
+                repeated->mutable_message()->append(suffix, suffixLength);
+            }
+            buffer.errors[i] = repeated;
+            buffer.nextRepeated.push_back(repeated);
+        }
+    }
+    buffer.repeated.swap(buffer.nextRepeated);
+    buffer.nextRepeated.clear();
+    // erase keeps the allocated capacity, unlike clear
+    // the list of the caller becomes the next buffer, thus it should be kept across calls as well
+    errors.erase(errors.begin(), errors.end());
+    errors.swap(buffer.errors);
+    buffer.errors.reserve(MAX_ERRORS_PER_SOURCE);
+    buffer.counts.erase(buffer.counts.begin(), buffer.counts.end());
 }
 
 QList<SSLSimError> ErrorAggregator::getAggregates(ErrorSource source) {
-    QList<SSLSimError>& ref = m_data[source];
-    QList<SSLSimError> out = ref;
-    ref.clear();
+    QList<SSLSimError> out;
+    takeAggregates(source, out);
     return out;
 }
@@ -21,27 +21,48 @@
 #ifndef SIM_AGGREGATOR_H
 #define SIM_AGGREGATOR_H
 #include <QObject>
-#include <QMap>
+#include <QList>
 #include "protobuf/sslsim.h"
+#include <vector>
 
 namespace camun {
     namespace simulator {
 
         enum class ErrorSource;
+        // collects the errors of one simulator tick per source
+        // identical errors are only reported once with a repetition count,
+        // if there are too many different errors the oldest ones are dropped
         class ErrorAggregator : public QObject {
             Q_OBJECT
         public:
-            ErrorAggregator(QObject* parent) : QObject(parent) {}
+            ErrorAggregator(QObject* parent);
+
+            static const int MAX_ERRORS_PER_SOURCE = 32;
 
         public slots:
             void aggregate(SSLSimError eror, ErrorSource e);
 
         public:
+            bool isEmpty(ErrorSource e) const;
+            // hands over the collected errors without copying them, errors is replaced
+            // the previous content of errors is dropped and its storage is reused for the next tick
+            void takeAggregates(ErrorSource e, QList<SSLSimError>& errors);
             QList<SSLSimError> getAggregates(ErrorSource e);
+
         private:
-            QMap<ErrorSource, QList<SSLSimError>> m_data;
+            struct Buffer {
+                // used as ring buffer once full, start is the oldest entry
+                QList<SSLSimError> errors;
+                QList<int> counts;
+                int start = 0;
+                // copies with the repetition note of the last reported tick, they are reported
+                // again instead of a new copy if the same error repeats as often as before
+                std::vector<SSLSimError> repeated;
+                std::vector<SSLSimError> nextRepeated;
+            };
+            static const int SOURCE_COUNT = 3;
+            Buffer m_data[SOURCE_COUNT];
         };
     }
 }
 #endif
-
@@ -0,0 +1,167 @@
+/***************************************************************************
+ *   Copyright 2021                                                        *
+ *   Robotics Erlangen e.V.                                                *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "groundtruthrecorder.h"
+#include <algorithm>
+
+using namespace camun::simulator;
+
+// number of float columns and index of the first column per field
+static const int FIELD_COLUMNS[] = {3, 3, 4, 3};
+static const int FIELD_OFFSET[] = {0, 3, 6, 10};
+
+GroundTruthRecorder::~GroundTruthRecorder()
+{
+    close();
+}
+
+bool GroundTruthRecorder::configure(const amun::GroundTruthExport &config, QString &error)
+{
+    close();
+    if (config.filename().empty()) {
+        return true;
+    }
+
+    m_fieldMask = 0;
+    for (int field : config.fields()) {
+        m_fieldMask |= 1u << field;
+    }
+    if (m_fieldMask == 0) {
+        m_fieldMask = (1u << FIELD_COUNT) - 1;
+    }
+    m_decimation = std::max(1u, config.decimation());
+    m_frameCounter = 0;
+
+    m_file.setFileName(QString::fromStdString(config.filename()));
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        error = m_file.errorString();
+        return false;
+    }
+
+    const quint32 version = VERSION;
+    m_file.write("ERGT", 4);
+    m_file.write(reinterpret_cast<const char *>(&version), sizeof(version));
+    m_file.write(reinterpret_cast<const char *>(&m_fieldMask), sizeof(m_fieldMask));
+
+    m_time.reserve(BLOCK_ROWS);
+    m_kind.reserve(BLOCK_ROWS);
+    m_id.reserve(BLOCK_ROWS);
+    for (int field = 0; field < FIELD_COUNT; field++) {
+        if (m_fieldMask & (1u << field)) {
+            for (int c = 0; c < FIELD_COLUMNS[field]; c++) {
+                m_columns[FIELD_OFFSET[field] + c].reserve(BLOCK_ROWS);
+            }
+        }
+    }
+    return true;
+}
+
+void GroundTruthRecorder::close()
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+    flush();
+    m_file.close();
+}
+
+bool GroundTruthRecorder::wantsFrame()
+{
+    if (!m_file.isOpen()) {
+        return false;
+    }
+    const bool wanted = m_frameCounter == 0;
+    m_frameCounter = (m_frameCounter + 1) % m_decimation;
+    return wanted;
+}
+
+void GroundTruthRecorder::record(qint64 time, const world::SimulatorState &state)
+{
+    float values[MAX_COLUMNS];
+    if (state.has_ball()) {
+        const world::SimBall &ball = state.ball();
+        const float ballValues[MAX_COLUMNS] = {
+            ball.p_x(), ball.p_y(), ball.p_z(),
+            ball.v_x(), ball.v_y(), ball.v_z(),
+            1, 0, 0, 0,
+            ball.angular_x(), ball.angular_y(), ball.angular_z()
+        };
+        addRow(time, 0, 0, ballValues);
+    }
+    for (int team = 0; team < 2; team++) {
+        const auto &robots = team == 0 ? state.blue_robots() : state.yellow_robots();
+        for (const world::SimRobot &robot : robots) {
+            values[0] = robot.p_x();
+            values[1] = robot.p_y();
+            values[2] = robot.p_z();
+            values[3] = robot.v_x();
+            values[4] = robot.v_y();
+            values[5] = robot.v_z();
+            values[6] = robot.rotation().real();
+            values[7] = robot.rotation().i();
+            values[8] = robot.rotation().j();
+            values[9] = robot.rotation().k();
+            values[10] = robot.r_x();
+            values[11] = robot.r_y();
+            values[12] = robot.r_z();
+            addRow(time, team + 1, robot.id(), values);
+        }
+    }
+}
+
+void GroundTruthRecorder::addRow(qint64 time, quint8 kind, quint8 id, const float *values)
+{
+    m_time.push_back(time);
+    m_kind.push_back(kind);
+    m_id.push_back(id);
+    for (int field = 0; field < FIELD_COUNT; field++) {
+        if (m_fieldMask & (1u << field)) {
+            for (int c = FIELD_OFFSET[field]; c < FIELD_OFFSET[field] + FIELD_COLUMNS[field]; c++) {
+                m_columns[c].push_back(values[c]);
+            }
+        }
+    }
+    if (m_time.size() >= BLOCK_ROWS) {
+        flush();
+    }
+}
+
+template<typename T>
+static void writeColumn(QFile &file, std::vector<T> &column)
+{
+    file.write(reinterpret_cast<const char *>(column.data()), column.size() * sizeof(T));
+    column.clear();
+}
+
+void GroundTruthRecorder::flush()
+{
+    if (m_time.empty()) {
+        return;
+    }
+    const quint32 rows = m_time.size();
+    m_file.write(reinterpret_cast<const char *>(&rows), sizeof(rows));
+    writeColumn(m_file, m_time);
+    writeColumn(m_file, m_kind);
+    writeColumn(m_file, m_id);
+    for (auto &column : m_columns) {
+        // disabled columns are always empty
+        writeColumn(m_file, column);
+    }
+}
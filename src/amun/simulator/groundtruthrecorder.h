@@ -0,0 +1,83 @@
+/***************************************************************************
+ *   Copyright 2021                                                        *
+ *   Robotics Erlangen e.V.                                                *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef GROUNDTRUTHRECORDER_H
+#define GROUNDTRUTHRECORDER_H
+
+#include "protobuf/command.pb.h"
+#include "protobuf/world.pb.h"
+#include <QFile>
+#include <QString>
+#include <vector>
+
+namespace camun {
+    namespace simulator {
+        class GroundTruthRecorder;
+    }
+}
+
+// writes the simulator ground truth to a file without going through protobuf
+//
+// File layout, all values in host byte order:
+//   header: "ERGT", uint32 version, uint32 field mask (bit i is set for GroundTruthExport::Field i)
+//   followed by blocks of at most BLOCK_ROWS rows, each consisting of
+//     uint32 row count n
+//     int64 time[n] (simulator time in ns), uint8 kind[n] (0 = ball, 1 = blue, 2 = yellow), uint8 id[n]
+//     float[n] for every column of the enabled fields, in the order of GroundTruthExport::Field
+// There is one row per object and recorded frame. Coordinates are the same as in world::SimulatorState.
+class camun::simulator::GroundTruthRecorder
+{
+public:
+    static const int BLOCK_ROWS = 4096;
+    static const quint32 VERSION = 1;
+
+    GroundTruthRecorder() = default;
+    ~GroundTruthRecorder();
+    GroundTruthRecorder(const GroundTruthRecorder&) = delete;
+    GroundTruthRecorder& operator=(const GroundTruthRecorder&) = delete;
+
+    // closes the current file and starts a new one if a filename is given, returns false on errors
+    bool configure(const amun::GroundTruthExport &config, QString &error);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+    // takes care of the decimation, the state is only read if the frame is recorded
+    bool wantsFrame();
+    void record(qint64 time, const world::SimulatorState &state);
+
+private:
+    void addRow(qint64 time, quint8 kind, quint8 id, const float *values);
+    void flush();
+
+    static const int FIELD_COUNT = 4;
+    static const int MAX_COLUMNS = 13;
+
+    QFile m_file;
+    quint32 m_fieldMask = 0;
+    unsigned m_decimation = 1;
+    unsigned m_frameCounter = 0;
+
+    std::vector<qint64> m_time;
+    std::vector<quint8> m_kind;
+    std::vector<quint8> m_id;
+    // only the columns of enabled fields are filled
+    std::vector<float> m_columns[MAX_COLUMNS];
+};
+
+#endif // GROUNDTRUTHRECORDER_H
@@ -0,0 +1,84 @@
+/***************************************************************************
+ *   Copyright 2021                                                        *
+ *   Robotics Erlangen e.V.                                                *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef BATCHSIMULATOR_H
+#define BATCHSIMULATOR_H
+
+#include "protobuf/command.h"
+#include "protobuf/robot.pb.h"
+#include "protobuf/sslsim.h"
+#include <QByteArray>
+#include <QList>
+#include <QPair>
+#include <QThreadPool>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace camun {
+    namespace simulator {
+        class BatchSimulator;
+    }
+}
+
+class camun::simulator::BatchSimulator
+{
+public:
+    struct WorldOutput
+    {
+        // serialized SSL_WrapperPackets together with the time they were sent
+        QList<QPair<qint64, QByteArray>> visionPackets;
+        // serialized world::SimulatorState, one for every vision frame
+        QList<QByteArray> simulatorStates;
+        QList<robot::RadioResponse> radioResponses;
+    };
+
+public:
+    // threadCount <= 0 uses one thread per core
+    explicit BatchSimulator(int threadCount = 0);
+    ~BatchSimulator();
+    BatchSimulator(const BatchSimulator&) = delete;
+    BatchSimulator& operator=(const BatchSimulator&) = delete;
+
+    // returns the index of the new world, the world is enabled and has no robots
+    int addWorld(const amun::SimulatorSetup &setup, uint32_t seed);
+    int worldCount() const { return m_worlds.size(); }
+    qint64 currentTime(int world) const;
+
+    // must not be called while step is running, except for the world passed to the step callback
+    void handleCommand(int world, const Command &command);
+    void handleRadioCommands(int world, const SSLSimRobotControl &control, bool isBlue);
+
+    // advances every world by delta nanoseconds, the worlds are distributed over the worker threads
+    void step(qint64 delta);
+    // the callback is called for each world every 10 ms simulation time (see FastSimulator::goWithCallback)
+    // it is run on the worker thread that currently steps the world passed as argument
+    void step(qint64 delta, const std::function<void(int)> &callback);
+
+    // returns and clears everything the world has produced since the last call
+    WorldOutput takeOutput(int world);
+
+private:
+    struct World;
+    std::vector<std::unique_ptr<World>> m_worlds;
+    QThreadPool m_pool;
+};
+
+#endif // BATCHSIMULATOR_H
@@ -0,0 +1,115 @@
+/***************************************************************************
+ *   Copyright 2021                                                        *
+ *   Robotics Erlangen e.V.                                                *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#ifndef ROBOTTABLE_H
+#define ROBOTTABLE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace camun {
+    namespace simulator {
+        class SimRobot;
+        class RobotTable;
+    }
+}
+
+// robots of one team, stored contiguously and ordered by id
+// the id lookup uses a fixed index, thus only the ids of the ssl (0 to 15) are supported
+class camun::simulator::RobotTable
+{
+public:
+    static const unsigned CAPACITY = 16;
+
+    struct Entry {
+        SimRobot *robot;
+        unsigned id;
+        unsigned generation;
+    };
+
+    RobotTable() { m_index.fill(NO_SLOT); }
+
+    static bool isValidId(unsigned id) { return id < CAPACITY; }
+
+    bool contains(unsigned id) const { return isValidId(id) && m_index[id] != NO_SLOT; }
+    Entry *find(unsigned id) { return contains(id) ? &m_entries[m_index[id]] : nullptr; }
+    const Entry *find(unsigned id) const { return contains(id) ? &m_entries[m_index[id]] : nullptr; }
+    SimRobot *robot(unsigned id) const { return contains(id) ? m_entries[m_index[id]].robot : nullptr; }
+
+    // returns false if the id is invalid or already in use
+    bool insert(unsigned id, SimRobot *robot, unsigned generation)
+    {
+        if (!isValidId(id) || contains(id)) {
+            return false;
+        }
+        std::size_t slot = m_size;
+        while (slot > 0 && m_entries[slot - 1].id > id) {
+            m_entries[slot] = m_entries[slot - 1];
+            m_index[m_entries[slot].id] = slot;
+            slot--;
+        }
+        m_entries[slot] = {robot, id, generation};
+        m_index[id] = slot;
+        m_size++;
+        return true;
+    }
+
+    // removes the robot from the table and returns it, the caller takes ownership
+    SimRobot *take(unsigned id)
+    {
+        if (!contains(id)) {
+            return nullptr;
+        }
+        std::size_t slot = m_index[id];
+        SimRobot *robot = m_entries[slot].robot;
+        m_index[id] = NO_SLOT;
+        m_size--;
+        for (; slot < m_size; slot++) {
+            m_entries[slot] = m_entries[slot + 1];
+            m_index[m_entries[slot].id] = slot;
+        }
+        return robot;
+    }
+
+    void clear()
+    {
+        m_index.fill(NO_SLOT);
+        m_size = 0;
+    }
+
+    std::size_t size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+
+    Entry *begin() { return m_entries.data(); }
+    Entry *end() { return m_entries.data() + m_size; }
+    const Entry *begin() const { return m_entries.data(); }
+    const Entry *end() const { return m_entries.data() + m_size; }
+
+private:
+    enum : std::uint8_t { NO_SLOT = 0xff };
+
+    std::array<Entry, CAPACITY> m_entries;
+    std::array<std::uint8_t, CAPACITY> m_index;
+    std::size_t m_size = 0;
+};
+
+#endif // ROBOTTABLE_H
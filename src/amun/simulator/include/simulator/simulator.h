@@ -26,9 +26,9 @@
 #include "protobuf/sslsim.h"
 #include <QList>
 #include <QMap>
-#include <QPair>
 #include <QQueue>
 #include <QByteArray>
+#include <memory>
 #include <tuple>
 
 // higher values break the rolling friction of the ball
@@ -45,15 +45,29 @@ class SSL_GeometryFieldSize;
 namespace camun {
     namespace simulator {
         class SimRobot;
+        class RobotTable;
         class Simulator;
         class ErrorAggregator;
         struct SimulatorData;
+        struct SimulatorSnapshot;
 
         enum class ErrorSource {
             BLUE,
             YELLOW,
             CONFIG
         };
+
+        // wall clock time spent in the phases of Simulator::process, in nanoseconds
+        struct PhaseTimings {
+            qint64 total = 0;
+            qint64 radioCommands = 0;
+            qint64 errorAggregation = 0;
+            qint64 physics = 0;
+            // excluding the serialization
+            qint64 visionPacket = 0;
+            qint64 serialization = 0;
+            qint64 processCalls = 0;
+        };
     }
 }
 
@@ -62,14 +76,26 @@ class camun::simulator::Simulator : public QObject
     Q_OBJECT
 
 public:
-    typedef QMap<unsigned int, QPair<SimRobot*, unsigned int>> RobotMap; /*First int: ID, Second int: Generation*/
-
     explicit Simulator(const Timer *timer, const amun::SimulatorSetup &setup, bool useManualTrigger = false);
     ~Simulator() override;
     Simulator(const Simulator&) = delete;
     Simulator& operator=(const Simulator&) = delete;
     void handleSimulatorTick(double timeStep);
+    // the ball and every robot derive their own noise stream from the seed
     void seedPRGN(uint32_t seed);
+    // lets robots without commands sleep and moves an isolated rolling ball analytically
+    // bullet is only used for the ball when it is close to a robot or the field border
+    void setAdaptiveStepping(bool adaptive) { m_adaptiveStepping = adaptive; }
+    // accumulated since construction or the last reset
+    const PhaseTimings &phaseTimings() const { return m_phaseTimings; }
+    void resetPhaseTimings() { m_phaseTimings = PhaseTimings(); }
+
+    // captures the complete dynamic state (bodies, robot internals, rng and queued packets)
+    // the snapshot can be restored into every simulator created with the same setup
+    std::shared_ptr<const SimulatorSnapshot> createSnapshot() const;
+    void restoreSnapshot(const SimulatorSnapshot &snapshot);
+    // creates an independent copy of this simulator including its configuration, driven by the given timer
+    std::unique_ptr<Simulator> fork(const Timer *timer) const;
 
 signals:
     void gotPacket(const QByteArray &data, qint64 time, QString sender);
@@ -93,21 +119,27 @@ private slots:
 
 private:
     void sendSSLSimErrorInternal(ErrorSource source);
-    void resetFlipped(RobotMap &robots, float side);
+    void resetFlipped(RobotTable &robots, float side);
     std::tuple<QList<QByteArray>, QByteArray, qint64> createVisionPacket();
+    void enqueueVisionPacket(const std::tuple<QList<QByteArray>, QByteArray, qint64> &packet);
+    void emitVisionPacket(const std::tuple<QList<QByteArray>, QByteArray, qint64> &packet, qint64 receiveTime);
+    void scheduleVisionPacket();
     void resetVisionPackets();
-    void setTeam(RobotMap &list, float side, const robot::Team &team, QMap<uint32_t, robot::Specs>& specs);
+    void setTeam(RobotTable &list, float side, const robot::Team &team, QMap<uint32_t, robot::Specs>& specs);
     void moveBall(const sslsim::TeleportBall &ball);
     void moveRobot(const sslsim::TeleportRobot &robot);
     void teleportRobotToFreePosition(SimRobot *robot);
     void initializeDetection(SSL_DetectionFrame *detection, std::size_t cameraId);
+    bool isBallIsolated(double timeDelta) const;
+    void applyPendingRadioCommand(unsigned id, bool isBlue);
+    void applyRadioCommand(const sslsim::RobotCommand &command, bool isBlue);
+    const QList<robot::RadioResponse> &takeRadioResponses();
 
 private:
-    typedef std::tuple<SSLSimRobotControl, qint64, bool> RadioCommand;
     SimulatorData *m_data;
-    QQueue<RadioCommand> m_radioCommands;
+    // ordered by delivery time (third element)
     QQueue<std::tuple<QList<QByteArray>, QByteArray, qint64>> m_visionPackets;
-    QQueue<QTimer *> m_visionTimers;
+    QTimer *m_visionTimer;
     bool m_isPartial;
     const Timer *m_timer;
     QTimer *m_trigger;
@@ -116,6 +148,8 @@ private:
     double m_timeScaling;
     bool m_enabled;
     bool m_charge;
+    bool m_adaptiveStepping = false;
+    PhaseTimings m_phaseTimings;
     // systemDelay + visionProcessingTime = visionDelay
     qint64 m_visionDelay;
     qint64 m_visionProcessingTime;
@@ -125,6 +159,8 @@ private:
     qint64 m_lastBallSendTime = 0;
     std::map<qint64, unsigned> m_lastFrameNumber;
     ErrorAggregator *m_aggregator;
+    // swapped with the buffers of the aggregator, thus its capacity is kept across ticks
+    QList<SSLSimError> m_errorBuffer;
 };
 
 #endif // SIMULATOR_H
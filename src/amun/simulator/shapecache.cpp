@@ -0,0 +1,92 @@
+/***************************************************************************
+ *   Copyright 2021                                                        *
+ *   Robotics Erlangen e.V.                                                *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "shapecache.h"
+#include "mesh.h"
+#include "simulator.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <btBulletDynamicsCommon.h>
+#include <map>
+#include <tuple>
+
+using namespace camun::simulator;
+
+RobotShapes::~RobotShapes()
+{
+    qDeleteAll(shapes);
+}
+
+// only the fields which influence the shapes
+typedef std::tuple<float, float, float, float, float> ShapeKey;
+
+static std::shared_ptr<RobotShapes> createRobotShapes(const robot::Specs &specs)
+{
+    auto result = std::make_shared<RobotShapes>();
+
+    btCompoundShape * wholeShape = new btCompoundShape;
+    btTransform robotShapeTransform;
+    robotShapeTransform.setIdentity();
+
+    // subtract collision margin from dimensions
+    Mesh mesh(specs.radius() - COLLISION_MARGIN / SIMULATOR_SCALE,
+              specs.height() - 2 * COLLISION_MARGIN / SIMULATOR_SCALE, specs.angle(), 0.04f, specs.dribbler_height() + 0.02f);
+    for (const QList<QVector3D> & hullPart : mesh.hull()) {
+        btConvexHullShape* hullPartShape = new btConvexHullShape;
+        result->shapes.append(hullPartShape);
+        for (const QVector3D& v : hullPart) {
+            hullPartShape->addPoint(btVector3(v.x(), v.y(), v.z()) * SIMULATOR_SCALE);
+        }
+        wholeShape->addChildShape(robotShapeTransform, hullPartShape);
+    }
+    result->shapes.append(wholeShape);
+    result->body = wholeShape;
+
+    btCylinderShape * dribblerShape = new btCylinderShapeX(btVector3(specs.dribbler_width() / 2.0f, 0.007f, 0.007f) * SIMULATOR_SCALE);
+    result->shapes.append(dribblerShape);
+    result->dribbler = dribblerShape;
+
+    return result;
+}
+
+std::shared_ptr<RobotShapes> camun::simulator::robotShapes(const robot::Specs &specs)
+{
+    static QMutex mutex;
+    // shapes are destroyed with the last robot using them
+    static std::map<ShapeKey, std::weak_ptr<RobotShapes>> cache;
+
+    const ShapeKey key(specs.radius(), specs.height(), specs.angle(), specs.dribbler_height(), specs.dribbler_width());
+
+    QMutexLocker locker(&mutex);
+    std::shared_ptr<RobotShapes> shapes = cache[key].lock();
+    if (!shapes) {
+        shapes = createRobotShapes(specs);
+        cache[key] = shapes;
+        // drop entries of expired shapes
+        for (auto it = cache.begin(); it != cache.end();) {
+            if (it->second.expired()) {
+                it = cache.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    return shapes;
+}
@@ -0,0 +1,56 @@
+/***************************************************************************
+ *   Copyright 2021                                                        *
+ *   Robotics Erlangen e.V.                                                *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef SHAPECACHE_H
+#define SHAPECACHE_H
+
+#include "protobuf/robot.pb.h"
+#include <QList>
+#include <memory>
+
+class btCollisionShape;
+class btCompoundShape;
+class btCylinderShape;
+
+namespace camun {
+    namespace simulator {
+        struct RobotShapes;
+
+        // returns the collision shapes for a robot with the given specs
+        // robots with identical geometry share their shapes, even across simulators
+        std::shared_ptr<RobotShapes> robotShapes(const robot::Specs &specs);
+    }
+}
+
+// bullet shapes are never modified after creation, thus they can be shared between bodies
+struct camun::simulator::RobotShapes
+{
+    RobotShapes() = default;
+    ~RobotShapes();
+    RobotShapes(const RobotShapes&) = delete;
+    RobotShapes& operator=(const RobotShapes&) = delete;
+
+    btCompoundShape *body = nullptr;
+    btCylinderShape *dribbler = nullptr;
+    // owns all shapes including the hull parts of body
+    QList<btCollisionShape*> shapes;
+};
+
+#endif // SHAPECACHE_H
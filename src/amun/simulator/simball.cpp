@@ -29,8 +29,15 @@
 
 using namespace camun::simulator;
 
-SimBall::SimBall(RNG *rng, btDiscreteDynamicsWorld *world) :
-    m_rng(rng),
+// just apply rolling friction, normal friction is somehow handled by bullet
+// this is quite a hack as it's always applied
+// but as the strong deceleration is more or less magic, some additional deceleration doesn't matter
+static const btScalar ROLLING_DECELERATION = 1.4 * 0.35;
+// the real ball snaps to a dimple below this speed
+static const btScalar BALL_STOP_SPEED = 0.01;
+
+SimBall::SimBall(uint32_t seed, btDiscreteDynamicsWorld *world) :
+    m_rng(seed),
     m_world(world)
 {
     // see http://robocup.mi.fu-berlin.de/buch/rolling.pdf for correct modelling
@@ -59,6 +66,19 @@ SimBall::SimBall(RNG *rng, btDiscreteDynamicsWorld *world) :
     m_world->addRigidBody(m_body);
 }
 
+void SimBall::reset()
+{
+    btTransform transform;
+    transform.setIdentity();
+    transform.setOrigin(btVector3(0, 0, BALL_RADIUS) * SIMULATOR_SCALE);
+    BodyState::atRest(transform).restore(m_body);
+    m_world->getBroadphase()->getOverlappingPairCache()->cleanProxyFromPairs(m_body->getBroadphaseHandle(), m_world->getDispatcher());
+
+    m_move.Clear();
+    m_rolling = false;
+    m_rollingVelocity.setZero();
+}
+
 SimBall::~SimBall()
 {
     m_world->removeRigidBody(m_body);
@@ -70,22 +90,17 @@ SimBall::~SimBall()
 void SimBall::begin()
 {
     // custom implementation of rolling friction
-    const btVector3 p = m_body->getWorldTransform().getOrigin();
-    if (p.z() < BALL_RADIUS * 1.1 * SIMULATOR_SCALE) { // ball is on the ground
+    // a rolling ball is handled in roll()
+    if (!m_rolling && isOnGround()) {
         const btVector3 velocity = m_body->getLinearVelocity();
-        if (velocity.length() < 0.01 * SIMULATOR_SCALE) {
+        if (velocity.length() < BALL_STOP_SPEED * SIMULATOR_SCALE) {
             // stop the ball if it is really slow
             // -> the real ball snaps to a dimple
             m_body->setLinearVelocity(btVector3(0, 0, 0));
         } else {
-            // just apply rolling friction, normal friction is somehow handled by bullet
-            // this is quite a hack as it's always applied
-            // but as the strong deceleration is more or less magic, some additional deceleration doesn't matter
-            const btScalar hackFactor = 1.4;
-            const btScalar rollingDeceleration = hackFactor * 0.35;
             btVector3 force(velocity.x(), velocity.y(), 0.0f);
             force.safeNormalize();
-            m_body->applyCentralImpulse(-force * rollingDeceleration * SIMULATOR_SCALE * BALL_MASS * SUB_TIMESTEP);
+            m_body->applyCentralImpulse(-force * ROLLING_DECELERATION * SIMULATOR_SCALE * BALL_MASS * SUB_TIMESTEP);
         }
     }
 
@@ -125,6 +140,7 @@ void SimBall::begin()
     }
 
     if (moveCommand) {
+        stopRolling();
         if(m_move.by_force()) {
 
             Vector pos;
@@ -279,7 +295,7 @@ bool SimBall::addDetection(SSL_DetectionBall *ball, btVector3 pos, float stddev,
         (cameraPosition.x()-pos.x())*(cameraPosition.x()-pos.x())+(cameraPosition.y()-pos.y())*(cameraPosition.y()-pos.y()));
     float denomSqrt = (distBallCam*1000)/FOCAL_LENGTH - 1;
     float basePixelArea = (BALL_RADIUS*BALL_RADIUS*1000000*M_PI) / (denomSqrt*denomSqrt);
-    float area = visibility * std::max(0.0f, (basePixelArea + static_cast<float>(m_rng->normal(stddevArea)) / PIXEL_PER_AREA));
+    float area = visibility * std::max(0.0f, (basePixelArea + static_cast<float>(m_rng.normal(stddevArea)) / PIXEL_PER_AREA));
     ball->set_area(area * PIXEL_PER_AREA);
 
     // if (height > 0.1f) {
@@ -288,7 +304,7 @@ bool SimBall::addDetection(SSL_DetectionBall *ball, btVector3 pos, float stddev,
 
     // add noise to coordinates
     // to convert from bullet coordinate system to ssl-vision rotate by 90 degree ccw
-    const Vector noise = m_rng->normalVector(stddev);
+    const Vector noise = m_rng.normalVector(stddev);
     coordinates::toVision(Vector(modX, modY) + noise, *ball);
     return true;
 }
@@ -328,6 +344,7 @@ void SimBall::writeBallState(world::SimBall *ball) const
 
 void SimBall::restoreState(const world::SimBall &ball)
 {
+    stopRolling();
     btVector3 position(ball.p_x(), ball.p_y(), ball.p_z());
     m_body->getWorldTransform().setOrigin(position * SIMULATOR_SCALE);
     btVector3 velocity(ball.v_x(), ball.v_y(), ball.v_z());
@@ -336,6 +353,92 @@ void SimBall::restoreState(const world::SimBall &ball)
     m_body->setAngularVelocity(angular);
 }
 
+SimBall::Snapshot SimBall::snapshot() const
+{
+    Snapshot snapshot;
+    snapshot.body.save(m_body);
+    snapshot.move = m_move;
+    snapshot.rolling = m_rolling;
+    snapshot.rollingVelocity = m_rollingVelocity;
+    snapshot.rng = m_rng;
+    return snapshot;
+}
+
+void SimBall::restoreSnapshot(const Snapshot &snapshot)
+{
+    snapshot.body.restore(m_body);
+    m_move = snapshot.move;
+    m_rolling = snapshot.rolling;
+    m_rollingVelocity = snapshot.rollingVelocity;
+    m_rng = snapshot.rng;
+}
+
+bool SimBall::isOnGround() const
+{
+    return m_body->getWorldTransform().getOrigin().z() < BALL_RADIUS * 1.1 * SIMULATOR_SCALE;
+}
+
+bool SimBall::isRollingWithoutSlip() const
+{
+    // velocity of the contact point with the floor
+    const btVector3 contactVelocity = m_body->getLinearVelocity()
+            + m_body->getAngularVelocity().cross(btVector3(0, 0, -BALL_RADIUS * SIMULATOR_SCALE));
+    return isOnGround() && contactVelocity.length() < 0.05f * SIMULATOR_SCALE;
+}
+
+void SimBall::startRolling()
+{
+    if (m_rolling) {
+        return;
+    }
+    m_rolling = true;
+    m_rollingVelocity = m_body->getLinearVelocity();
+    m_rollingVelocity.setZ(0);
+    // bullet resets the velocity of sleeping bodies, it is kept in m_rollingVelocity instead
+    m_body->setActivationState(ISLAND_SLEEPING);
+}
+
+void SimBall::roll(btScalar timeStep)
+{
+    if (!m_rolling) {
+        return;
+    }
+
+    btTransform transform = m_body->getWorldTransform();
+    const btScalar speed = m_rollingVelocity.length();
+    const btScalar deceleration = ROLLING_DECELERATION * SIMULATOR_SCALE;
+    if (speed < BALL_STOP_SPEED * SIMULATOR_SCALE) {
+        m_rollingVelocity.setZero();
+    } else if (speed <= deceleration * timeStep) {
+        // the ball stops during this step
+        transform.getOrigin() += m_rollingVelocity * (speed / (2 * deceleration));
+        m_rollingVelocity.setZero();
+    } else {
+        transform.getOrigin() += m_rollingVelocity * (timeStep - 0.5f * deceleration * timeStep * timeStep / speed);
+        m_rollingVelocity *= (speed - deceleration * timeStep) / speed;
+    }
+
+    m_body->setWorldTransform(transform);
+    m_body->setInterpolationWorldTransform(transform);
+    // motion states of sleeping bodies aren't synchronized by bullet
+    m_motionState->setWorldTransform(transform);
+    // publish the velocity for everyone reading the ball state, bullet resets it during the next step
+    m_body->setLinearVelocity(m_rollingVelocity);
+    // rolling without slipping
+    m_body->setAngularVelocity(btVector3(0, 0, 1).cross(m_rollingVelocity) / (BALL_RADIUS * SIMULATOR_SCALE));
+}
+
+void SimBall::stopRolling()
+{
+    if (!m_rolling) {
+        return;
+    }
+    m_rolling = false;
+    m_body->setLinearVelocity(m_rollingVelocity);
+    m_body->setAngularVelocity(btVector3(0, 0, 1).cross(m_rollingVelocity) / (BALL_RADIUS * SIMULATOR_SCALE));
+    m_body->activate(true);
+}
+
 bool SimBall::isInvalid() const
 {
     const btTransform transform = m_body->getWorldTransform();
@@ -351,6 +454,7 @@ bool SimBall::isInvalid() const
 
 void SimBall::kick(const btVector3 &power)
 {
+    stopRolling();
     m_body->activate();
     m_body->applyCentralForce(power);
 
@@ -23,15 +23,16 @@
 
 #include "protobuf/command.pb.h"
 #include "protobuf/sslsim.h"
+#include "core/rng.h"
 #include <btBulletDynamicsCommon.h>
 #include "simfield.h"
+#include "bodystate.h"
 #include <QObject>
 
 static const float BALL_RADIUS = 0.0215f;
 static const float BALL_MASS = 0.046f;
 static const float BALL_DECELERATION = 0.5f;
 
-class RNG;
 class SSL_DetectionBall;
 
 namespace camun {
@@ -45,7 +46,19 @@ class camun::simulator::SimBall: public QObject
 {
     Q_OBJECT
 public:
-    SimBall(RNG *rng, btDiscreteDynamicsWorld *world);
+    // full internal state of the ball, see Simulator::createSnapshot
+    struct Snapshot
+    {
+        BodyState body;
+        sslsim::TeleportBall move;
+        bool rolling;
+        btVector3 rollingVelocity;
+        RNG rng;
+    };
+
+public:
+    // the ball has its own noise generator, see Simulator::seedPRGN
+    SimBall(uint32_t seed, btDiscreteDynamicsWorld *world);
     ~SimBall();
     SimBall(const SimBall&) = delete;
     SimBall& operator=(const SimBall&) = delete;
@@ -59,25 +72,42 @@ public:
                bool enableInvisibleBall, float visibilityThreshold);
     void move(const sslsim::TeleportBall &ball);
     void kick(const btVector3 &power);
+    void seedNoise(uint32_t seed) { m_rng.seed(seed); }
     // returns the ball position projected onto the floor (z component is not included)
     btVector3 position() const;
     btVector3 speed() const;
     void writeBallState(world::SimBall *ball) const;
     void restoreState(const world::SimBall &ball);
+    Snapshot snapshot() const;
+    void restoreSnapshot(const Snapshot &snapshot);
+    // puts the ball back into the state it had after construction
+    void reset();
     btRigidBody *body() const { return m_body; }
     bool isInvalid() const;
+    bool isOnGround() const;
+    // true if the ball rests or rolls without slipping on the floor
+    bool isRollingWithoutSlip() const;
+
+    // analytic model for a ball rolling without any contacts
+    // the body sleeps while rolling, thus it is ignored by bullet
+    void startRolling();
+    void roll(btScalar timeStep);
+    void stopRolling();
+    bool isRolling() const { return m_rolling; }
 
     // can be used to add ball mis-detections
     bool addDetection(SSL_DetectionBall *ball, btVector3 pos, float stddev, float stddevArea, const btVector3 &cameraPosition,
                       bool enableInvisibleBall, float visibilityThreshold);
 
 private:
-    RNG *m_rng;
+    RNG m_rng;
     btDiscreteDynamicsWorld *m_world;
     btCollisionShape *m_sphere;
     btRigidBody *m_body;
     btMotionState *m_motionState;
     sslsim::TeleportBall m_move;
+    bool m_rolling = false;
+    btVector3 m_rollingVelocity{0, 0, 0};
 };
 
 #endif // SIMBALL_H
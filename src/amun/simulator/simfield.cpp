@@ -28,8 +28,6 @@ SimField::SimField(btDiscreteDynamicsWorld *world, const world::Geometry &geomet
 {
     const float totalWidth = geometry.field_width() / 2.0f + geometry.boundary_width();
     const float totalHeight = geometry.field_height() / 2.0f + geometry.boundary_width();
-    // upper boundary
-    const float roomHeight = 8.0f;
     const float height = geometry.field_height() / 2.0f - geometry.line_width();
     const float goalWidthHalf = geometry.goal_width() / 2.0f + geometry.goal_wall_width();
     const float goalHeightHalf = geometry.goal_height() / 2.0f;
@@ -46,7 +44,7 @@ SimField::SimField(btDiscreteDynamicsWorld *world, const world::Geometry &geomet
     // floor
     addObject(m_plane, btTransform(btQuaternion(btVector3(1, 0, 0), 0), btVector3(0, 0, 0) * SIMULATOR_SCALE), 0.56, 0.35);
     // others
-    addObject(m_plane, btTransform(btQuaternion(btVector3(1, 0, 0), M_PI), btVector3(0, 0, roomHeight) * SIMULATOR_SCALE), 0.3, 0.35);
+    addObject(m_plane, btTransform(btQuaternion(btVector3(1, 0, 0), M_PI), btVector3(0, 0, ROOM_HEIGHT) * SIMULATOR_SCALE), 0.3, 0.35);
 
     addObject(m_plane, btTransform(btQuaternion(btVector3(1, 0, 0),  M_PI_2), btVector3(0,  totalHeight, 0) * SIMULATOR_SCALE), 0.3, 0.35);
     addObject(m_plane, btTransform(btQuaternion(btVector3(1, 0, 0), -M_PI_2), btVector3(0, -totalHeight, 0) * SIMULATOR_SCALE), 0.3, 0.35);
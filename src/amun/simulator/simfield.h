@@ -31,6 +31,9 @@ namespace camun {
     }
 }
 
+// height of the ceiling above the field in meters, every object stays below it
+const float ROOM_HEIGHT = 8.0f;
+
 class camun::simulator::SimField
 {
 public:
@@ -20,7 +20,7 @@
 
 #include "core/rng.h"
 #include "core/coordinates.h"
-#include "mesh.h"
+#include "shapecache.h"
 #include "protobuf/ssl_detection.pb.h"
 #include "simball.h"
 #include "simrobot.h"
@@ -30,6 +30,8 @@
 using namespace camun::simulator;
 
 const float MAX_SPEED = 1000;
+// kinematic robots are put into this group, which is excluded from their collision mask
+const short ROBOT_COLLISION_GROUP = btBroadphaseProxy::CharacterFilter << 1;
 
 float boundSpeed(float speed)
 {
@@ -37,8 +39,8 @@ float boundSpeed(float speed)
 }
 
 
-SimRobot::SimRobot(RNG *rng, const robot::Specs &specs, btDiscreteDynamicsWorld *world, const btVector3 &pos, float dir) :
-    m_rng(rng),
+SimRobot::SimRobot(uint32_t seed, const robot::Specs &specs, btDiscreteDynamicsWorld *world, const btVector3 &pos, float dir) :
+    m_rng(seed),
     m_specs(specs),
     m_world(world),
     m_charge(false),
@@ -51,22 +53,8 @@ SimRobot::SimRobot(RNG *rng, const robot::Specs &specs, btDiscreteDynamicsWorld
     error_sum_omega(0)
 {
 
-    btCompoundShape * wholeShape = new btCompoundShape;
-    btTransform robotShapeTransform;
-    robotShapeTransform.setIdentity();
-
-    // subtract collision margin from dimensions
-    Mesh mesh(m_specs.radius() - COLLISION_MARGIN / SIMULATOR_SCALE,
-              m_specs.height() - 2 * COLLISION_MARGIN / SIMULATOR_SCALE, m_specs.angle(), 0.04f, m_specs.dribbler_height() + 0.02f);
-    for (const QList<QVector3D> & hullPart : mesh.hull()) {
-        btConvexHullShape* hullPartShape = new btConvexHullShape;
-        m_shapes.append(hullPartShape);
-        for (const QVector3D& v : hullPart) {
-            hullPartShape->addPoint(btVector3(v.x(), v.y(), v.z()) * SIMULATOR_SCALE);
-        }
-        wholeShape->addChildShape(robotShapeTransform, hullPartShape);
-    }
-    m_shapes.append(wholeShape);
+    m_shapes = robotShapes(m_specs);
+    btCompoundShape * wholeShape = m_shapes->body;
 
     btTransform startWorldTransform;
     startWorldTransform.setIdentity();
@@ -85,10 +73,8 @@ SimRobot::SimRobot(RNG *rng, const robot::Specs &specs, btDiscreteDynamicsWorld
     // see simulator.cpp
     m_body->setRestitution(0.6f);
     m_body->setFriction(0.22f);
-    m_world->addRigidBody(m_body);
 
-    btCylinderShape * dribblerShape = new btCylinderShapeX(btVector3(m_specs.dribbler_width() / 2.0f, 0.007f, 0.007f) * SIMULATOR_SCALE);
-    m_shapes.append(dribblerShape);
+    btCylinderShape * dribblerShape = m_shapes->dribbler;
     // WARNING: hack, instead of 0.02 should be the dribbler height
     // the ball seems to get instable if the dribbler is at correct height
     // possibly the ball gets 'sucked' onto the robot
@@ -107,7 +93,6 @@ SimRobot::SimRobot(RNG *rng, const robot::Specs &specs, btDiscreteDynamicsWorld
     dribblerBody->setRestitution(0.2f);
     dribblerBody->setFriction(1.5f);
     m_dribblerBody = dribblerBody;
-    m_world->addRigidBody(dribblerBody);
 
     btTransform localA, localB;
     localA.setIdentity();
@@ -117,7 +102,7 @@ SimRobot::SimRobot(RNG *rng, const robot::Specs &specs, btDiscreteDynamicsWorld
     localB.setRotation(btQuaternion(btVector3(0, 1, 0), M_PI_2));
     m_dribblerConstraint = new btHingeConstraint(*m_body, *dribblerBody, localA, localB);
     m_dribblerConstraint->enableAngularMotor(false, 0, 0);
-    m_world->addConstraint(m_dribblerConstraint, true);
+    addToWorld();
 }
 
 SimRobot::~SimRobot()
@@ -132,7 +117,6 @@ SimRobot::~SimRobot()
     delete m_body;
     delete m_dribblerBody;
     delete m_motionState;
-    qDeleteAll(m_shapes);
 }
 
 void SimRobot::calculateDribblerMove(const btVector3 pos, const btQuaternion rot, const btVector3 linVel, float omega)
@@ -385,6 +369,22 @@ void SimRobot::begin(SimBall *ball, double time)
     const float error_v_f = v_d_local.y() - v_f;
     const float error_omega = boundSpeed(output_omega) - omega;
 
+    const float accelScale = 2.f; // let robot accelerate / brake faster than the accelerator does
+    if (m_kinematic) {
+        // reach the commanded speed as fast as the acceleration limits allow, there are no forces involved
+        const float a_f = bound(error_v_f / time, v_f, accelScale*m_specs.strategy().a_speedup_f_max(), accelScale*m_specs.strategy().a_brake_f_max());
+        const float a_s = bound(error_v_s / time, v_s, accelScale*m_specs.strategy().a_speedup_s_max(), accelScale*m_specs.strategy().a_brake_s_max());
+        const float a_phi = bound(error_omega / time, omega, accelScale*m_specs.strategy().a_speedup_phi_max(), accelScale*m_specs.strategy().a_brake_phi_max());
+
+        btVector3 velocity = t * btVector3(v_s + a_s * time, v_f + a_f * time, 0) * SIMULATOR_SCALE;
+        velocity.setZ(m_body->getLinearVelocity().z());
+        m_body->activate();
+        m_body->setDamping(0.0, 0.0);
+        m_body->setLinearVelocity(velocity);
+        m_body->setAngularVelocity(btVector3(0, 0, omega + a_phi * time));
+        return;
+    }
+
     error_sum_v_s += error_v_s;
     error_sum_v_f += error_v_f;
     error_sum_omega += error_omega;
@@ -404,7 +404,6 @@ void SimRobot::begin(SimBall *ball, double time)
     float a_f = V*v_f + K*error_v_f + K_I*error_sum_v_f;
     float a_s = V*v_s + K*error_v_s + K_I*error_sum_v_s;
 
-    const float accelScale = 2.f; // let robot accelerate / brake faster than the accelerator does
     a_f = bound(a_f, v_f, accelScale*m_specs.strategy().a_speedup_f_max(), accelScale*m_specs.strategy().a_brake_f_max());
     a_s = bound(a_s, v_s, accelScale*m_specs.strategy().a_speedup_s_max(), accelScale*m_specs.strategy().a_brake_s_max());
     const btVector3 force(a_s*m_specs.mass(), a_f*m_specs.mass(), 0);
@@ -482,21 +481,22 @@ bool SimRobot::canKickBall(SimBall *ball) const
     return false;
 }
 
-robot::RadioResponse SimRobot::setCommand(const sslsim::RobotCommand &command, SimBall *ball, bool charge, float rxLoss, float txLoss)
+void SimRobot::setCommand(const sslsim::RobotCommand &command, SimBall *ball, bool charge, float rxLoss, float txLoss, robot::RadioResponse *response)
 {
-    m_sslCommand = command;
+    m_sslCommand.CopyFrom(command);
     m_commandTime = 0.0f;
     m_charge = charge;
 
-    robot::RadioResponse response;
-    response.set_generation(m_specs.generation());
-    response.set_id(m_specs.id());
-    response.set_battery(1);
+    // keeps the allocated sub messages
+    response->Clear();
+    response->set_generation(m_specs.generation());
+    response->set_id(m_specs.id());
+    response->set_battery(1);
     // TODO: actually compute the packet loss
-    response.set_packet_loss_rx(rxLoss);
-    response.set_packet_loss_tx(txLoss);
-    response.set_ball_detected(canKickBall(ball));
-    response.set_cap_charged(m_isCharged);
+    response->set_packet_loss_rx(rxLoss);
+    response->set_packet_loss_tx(txLoss);
+    response->set_ball_detected(canKickBall(ball));
+    response->set_cap_charged(m_isCharged);
 
     // current velocities
     btTransform t = m_body->getWorldTransform();
@@ -506,12 +506,10 @@ robot::RadioResponse SimRobot::setCommand(const sslsim::RobotCommand &command, S
     float v_s = v_local.x()/SIMULATOR_SCALE;
     float omega = m_body->getAngularVelocity().z();
 
-    robot::SpeedStatus *speedStatus = response.mutable_estimated_speed();
+    robot::SpeedStatus *speedStatus = response->mutable_estimated_speed();
     speedStatus->set_v_f(v_f);
     speedStatus->set_v_s(v_s);
     speedStatus->set_omega(omega);
-
-    return response;
 }
 
 void SimRobot::update(SSL_DetectionRobot *robot, float stddev_p, float stddev_phi, qint64 time)
@@ -526,13 +524,13 @@ void SimRobot::update(SSL_DetectionRobot *robot, float stddev_p, float stddev_ph
     btTransform transform;
     m_motionState->getWorldTransform(transform);
     const btVector3 p = transform.getOrigin() / SIMULATOR_SCALE;
-    const Vector p_noise = m_rng->normalVector(stddev_p);
+    const Vector p_noise = m_rng.normalVector(stddev_p);
     robot->set_x((p.y() + p_noise.x) * 1000.0f);
     robot->set_y(-(p.x() + p_noise.y) * 1000.0f);
 
     const btQuaternion q = transform.getRotation();
     const btVector3 dir = btMatrix3x3(q).getColumn(0);
-    robot->set_orientation(atan2(dir.y(), dir.x()) + m_rng->normal(stddev_phi));
+    robot->set_orientation(atan2(dir.y(), dir.x()) + m_rng.normal(stddev_phi));
 
     m_lastSendTime = time;
 }
@@ -567,6 +565,8 @@ void SimRobot::update(world::SimRobot* robot) const
 
 void SimRobot::restoreState(const world::SimRobot &robot)
 {
+    m_body->activate();
+    m_dribblerBody->activate();
     btVector3 position(robot.p_x(), robot.p_y(), robot.p_z());
     m_body->getWorldTransform().setOrigin(position * SIMULATOR_SCALE);
     btQuaternion rotation(robot.rotation().real(), robot.rotation().i(), robot.rotation().j(), robot.rotation().k());
@@ -577,6 +577,141 @@ void SimRobot::restoreState(const world::SimRobot &robot)
     m_body->setAngularVelocity(angular);
 }
 
+bool SimRobot::isIdle() const
+{
+    const bool hasMove = m_move.has_x() || m_move.has_y() || m_move.has_v_x() || m_move.has_v_y()
+            || m_move.has_v_angular() || m_move.by_force();
+    return m_commandTime > 0.1 && !hasMove && !m_holdBallConstraint;
+}
+
+void SimRobot::trySleep()
+{
+    if (isSleeping() || !isIdle()) {
+        return;
+    }
+    if (m_body->getLinearVelocity().length() > 0.01f * SIMULATOR_SCALE || m_body->getAngularVelocity().length() > 0.1f) {
+        return;
+    }
+    // bullet only deactivates bodies after two seconds at rest
+    m_body->setActivationState(ISLAND_SLEEPING);
+    m_dribblerBody->setActivationState(ISLAND_SLEEPING);
+}
+
+SimRobot::Snapshot SimRobot::snapshot() const
+{
+    Snapshot snapshot;
+    snapshot.body.save(m_body);
+    snapshot.dribbler.save(m_dribblerBody);
+    snapshot.holdsBall = bool(m_holdBallConstraint);
+    if (m_holdBallConstraint) {
+        snapshot.holdBallFrameA = m_holdBallConstraint->getAFrame();
+        snapshot.holdBallFrameB = m_holdBallConstraint->getBFrame();
+    }
+    snapshot.move = m_move;
+    snapshot.command = m_sslCommand;
+    snapshot.charge = m_charge;
+    snapshot.isCharged = m_isCharged;
+    snapshot.inStandby = m_inStandby;
+    snapshot.shootTime = m_shootTime;
+    snapshot.commandTime = m_commandTime;
+    snapshot.errorSumVS = error_sum_v_s;
+    snapshot.errorSumVF = error_sum_v_f;
+    snapshot.errorSumOmega = error_sum_omega;
+    snapshot.perfectDribbler = m_perfectDribbler;
+    snapshot.lastSendTime = m_lastSendTime;
+    snapshot.rng = m_rng;
+    return snapshot;
+}
+
+void SimRobot::restoreSnapshot(const Snapshot &snapshot, SimBall *ball, qint64 timeOffset)
+{
+    stopDribbling();
+    snapshot.body.restore(m_body);
+    snapshot.dribbler.restore(m_dribblerBody);
+    if (snapshot.holdsBall) {
+        m_holdBallConstraint.reset(new btHingeConstraint(*m_body, *ball->body(), snapshot.holdBallFrameA, snapshot.holdBallFrameB));
+        m_world->addConstraint(m_holdBallConstraint.get(), true);
+    }
+    m_move = snapshot.move;
+    m_sslCommand = snapshot.command;
+    m_charge = snapshot.charge;
+    m_isCharged = snapshot.isCharged;
+    m_inStandby = snapshot.inStandby;
+    m_shootTime = snapshot.shootTime;
+    m_commandTime = snapshot.commandTime;
+    error_sum_v_s = snapshot.errorSumVS;
+    error_sum_v_f = snapshot.errorSumVF;
+    error_sum_omega = snapshot.errorSumOmega;
+    m_perfectDribbler = snapshot.perfectDribbler;
+    m_lastSendTime = snapshot.lastSendTime + timeOffset;
+    m_rng = snapshot.rng;
+}
+
+void SimRobot::reset(const btVector3 &pos, float dir)
+{
+    stopDribbling();
+
+    const btTransform transform(btQuaternion(btVector3(0, 0, 1), dir - M_PI_2),
+                                btVector3(pos.x(), pos.y(), m_specs.height() / 2.0f) * SIMULATOR_SCALE);
+    BodyState::atRest(transform).restore(m_body);
+    BodyState::atRest(transform * btTransform(btQuaternion::getIdentity(), m_dribblerCenter)).restore(m_dribblerBody);
+
+    // drop contacts from the previous position
+    for (btRigidBody *body : {m_body, m_dribblerBody}) {
+        m_world->getBroadphase()->getOverlappingPairCache()->cleanProxyFromPairs(body->getBroadphaseHandle(), m_world->getDispatcher());
+    }
+
+    m_move.Clear();
+    m_sslCommand.Clear();
+    m_charge = false;
+    m_isCharged = false;
+    m_inStandby = false;
+    m_shootTime = 0.0;
+    m_commandTime = 0.0;
+    error_sum_v_s = 0;
+    error_sum_v_f = 0;
+    error_sum_omega = 0;
+    m_perfectDribbler = false;
+    m_lastSendTime = 0;
+}
+
+void SimRobot::detach()
+{
+    stopDribbling();
+    m_world->removeConstraint(m_dribblerConstraint);
+    m_world->removeRigidBody(m_dribblerBody);
+    m_world->removeRigidBody(m_body);
+}
+
+void SimRobot::attach()
+{
+    addToWorld();
+}
+
+void SimRobot::setKinematic(bool kinematic)
+{
+    if (kinematic == m_kinematic) {
+        return;
+    }
+    // the collision filter can only be set when adding the bodies
+    detach();
+    m_kinematic = kinematic;
+    addToWorld();
+}
+
+void SimRobot::addToWorld()
+{
+    if (m_kinematic) {
+        const short mask = btBroadphaseProxy::AllFilter & ~ROBOT_COLLISION_GROUP;
+        m_world->addRigidBody(m_body, ROBOT_COLLISION_GROUP, mask);
+        m_world->addRigidBody(m_dribblerBody, ROBOT_COLLISION_GROUP, mask);
+    } else {
+        m_world->addRigidBody(m_body);
+        m_world->addRigidBody(m_dribblerBody);
+    }
+    m_world->addConstraint(m_dribblerConstraint, true);
+}
+
 void SimRobot::move(const sslsim::TeleportRobot &robot)
 {
     m_move = robot;
@@ -24,10 +24,13 @@
 #include "protobuf/command.pb.h"
 #include "protobuf/robot.pb.h"
 #include "protobuf/sslsim.h"
+#include "core/rng.h"
+#include "bodystate.h"
+#include "shapecache.h"
 #include <QList>
 #include <btBulletDynamicsCommon.h>
+#include <memory>
 
-class RNG;
 class SSL_DetectionRobot;
 
 namespace camun {
@@ -42,7 +45,32 @@ class camun::simulator::SimRobot: public QObject
 {
     Q_OBJECT
 public:
-    SimRobot(RNG *rng, const robot::Specs &specs, btDiscreteDynamicsWorld *world, const btVector3 &pos, float dir);
+    // full internal state of the robot, see Simulator::createSnapshot
+    struct Snapshot
+    {
+        BodyState body;
+        BodyState dribbler;
+        bool holdsBall;
+        btTransform holdBallFrameA;
+        btTransform holdBallFrameB;
+        sslsim::TeleportRobot move;
+        sslsim::RobotCommand command;
+        bool charge;
+        bool isCharged;
+        bool inStandby;
+        double shootTime;
+        double commandTime;
+        float errorSumVS;
+        float errorSumVF;
+        float errorSumOmega;
+        bool perfectDribbler;
+        qint64 lastSendTime;
+        RNG rng;
+    };
+
+public:
+    // every robot has its own noise generator, see Simulator::seedPRGN
+    SimRobot(uint32_t seed, const robot::Specs &specs, btDiscreteDynamicsWorld *world, const btVector3 &pos, float dir);
     ~SimRobot();
     SimRobot(const SimRobot&) = delete;
     SimRobot& operator=(const SimRobot&) = delete;
@@ -54,16 +82,37 @@ public:
     void begin(SimBall *ball, double time);
     bool canKickBall(SimBall *ball) const;
     void tryKick(SimBall *ball, float power, double time);
-    robot::RadioResponse setCommand(const sslsim::RobotCommand &command, SimBall *ball, bool charge, float rxLoss, float txLoss);
+    // the response is filled in place, to allow reusing it
+    void setCommand(const sslsim::RobotCommand &command, SimBall *ball, bool charge, float rxLoss, float txLoss, robot::RadioResponse *response);
     void update(SSL_DetectionRobot *robot, float stddev_p, float stddev_phi, qint64 time);
     void update(world::SimRobot *robot) const;
     void restoreState(const world::SimRobot &robot);
+    Snapshot snapshot() const;
+    // timeOffset is added to all stored timestamps
+    void restoreSnapshot(const Snapshot &snapshot, SimBall *ball, qint64 timeOffset);
+    // puts the robot back into the state it had after construction at the given position
+    void reset(const btVector3 &pos, float dir);
+    void seedNoise(uint32_t seed) { m_rng.seed(seed); }
+    // for random events concerning only this robot, like radio packet loss
+    RNG &noise() { return m_rng; }
+    // removes the bodies from the world or adds them again, used to keep unused robots for later reuse
+    void detach();
+    void attach();
+    // kinematic robots don't collide with other robots and are driven by setting their speed directly
+    void setKinematic(bool kinematic);
     void move(const sslsim::TeleportRobot &robot);
     bool isFlipped();
     btVector3 position() const;
     btVector3 dribblerCorner(bool left) const;
     qint64 getLastSendTime() const { return m_lastSendTime; }
     void setDribbleMode(bool perfectDribbler);
+    btVector3 speed() const { return m_body->getLinearVelocity(); }
+
+    // robot without command, teleport or held ball
+    bool isIdle() const;
+    bool isSleeping() const { return !m_body->isActive(); }
+    // puts an idle robot, that has come to rest, to sleep
+    void trySleep();
 
     const robot::Specs& specs() const { return m_specs; }
 
@@ -73,14 +122,15 @@ private:
     void calculateDribblerMove(const btVector3 pos, const btQuaternion rot, const btVector3 linVel, float omega);
     void dribble(SimBall *ball, float speed);
     void stopDribbling();
+    void addToWorld();
 
-    RNG *m_rng;
+    RNG m_rng;
     robot::Specs m_specs;
     btDiscreteDynamicsWorld *m_world;
     btRigidBody * m_body;
     btRigidBody * m_dribblerBody;
     btHingeConstraint *m_dribblerConstraint;
-    QList<btCollisionShape*> m_shapes;
+    std::shared_ptr<RobotShapes> m_shapes;
     btMotionState * m_motionState;
     btVector3 m_dribblerCenter;
     std::unique_ptr<btHingeConstraint> m_holdBallConstraint;
@@ -105,6 +155,7 @@ private:
     float error_sum_omega;
 
     bool m_perfectDribbler = false;
+    bool m_kinematic = false;
 
     qint64 m_lastSendTime = 0;
 };
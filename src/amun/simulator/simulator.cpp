@@ -28,13 +28,29 @@
 #include "simfield.h"
 #include "simrobot.h"
 #include "erroraggregator.h"
+#include "robottable.h"
+#include "groundtruthrecorder.h"
+#include <QMetaMethod>
 #include <QTimer>
 #include <algorithm>
+#include <cmath>
+#include <map>
+#include <string>
 #include <QtDebug>
 #include <QVector>
 
 using namespace camun::simulator;
 
+// every object draws its noise from its own stream derived from the world seed,
+// thus adding a robot doesn't change the noise of any other object
+static const uint64_t WORLD_NOISE_STREAM = 0;
+static const uint64_t BALL_NOISE_STREAM = 1;
+
+static uint64_t robotNoiseStream(bool isBlue, unsigned id)
+{
+    return 2 + (isBlue ? 0 : RobotTable::CAPACITY) + id;
+}
+
 /* Friction and restitution between robots, ball and field: (empirical measurments)
  * Ball vs. Robot:
  * Restitution: about 0.60
@@ -64,7 +80,9 @@ using namespace camun::simulator;
 
 struct camun::simulator::SimulatorData
 {
+    // used for the missing ball detections, everything concerning a single object uses its own generator
     RNG rng;
+    uint32_t seed;
     btDefaultCollisionConfiguration *collision;
     btCollisionDispatcher *dispatcher;
     btBroadphaseInterface *overlappingPairCache;
@@ -73,12 +91,44 @@ struct camun::simulator::SimulatorData
     world::Geometry geometry;
     QVector<SSL_GeometryCameraCalibration> reportedCameraSetup;
     QVector<btVector3> cameraPositions;
+    // buffers of the per frame camera assignment, reused to avoid allocations
+    struct CameraAssignment {
+        // the ball is object 0 followed by the blue and yellow robots
+        std::vector<float> objectsX;
+        std::vector<float> objectsY;
+        // indexed as [camera * numObjects + object]
+        std::vector<float> distances;
+        std::vector<float> minDistance;
+        std::vector<char> visible;
+    };
+    CameraAssignment cameraAssignment;
     SimField *field;
     SimBall *ball;
-    Simulator::RobotMap robotsBlue;
-    Simulator::RobotMap robotsYellow;
+    RobotTable robotsBlue;
+    RobotTable robotsYellow;
     QMap<uint32_t, robot::Specs> specsBlue;
     QMap<uint32_t, robot::Specs> specsYellow;
+    // detached robots for reuse, keyed by their serialized specs
+    std::multimap<std::string, SimRobot*> robotPool;
+    // latest received radio command per team (yellow, blue) and robot id
+    // the messages are reused to avoid allocations
+    struct CommandSlot {
+        sslsim::RobotCommand command;
+        // the command is applied by the first process call after this time
+        qint64 receiveTime = 0;
+        bool valid = false;
+    };
+    CommandSlot radioCommands[2][RobotTable::CAPACITY];
+    // radio responses of the current tick per team (yellow, blue) and robot id
+    // the messages are reused to avoid allocations
+    struct ResponseSlot {
+        robot::RadioResponse response;
+        bool valid = false;
+    };
+    ResponseSlot radioResponses[2][RobotTable::CAPACITY];
+    robot::RadioResponse scratchResponse;
+    // handed out by takeRadioResponses, the elements are reused across ticks
+    QList<robot::RadioResponse> responseBuffer;
     bool flip;
     float stddevBall;
     float stddevBallArea;
@@ -92,6 +142,36 @@ struct camun::simulator::SimulatorData
     float robotCommandPacketLoss;
     float robotReplyPacketLoss;
     float missingBallDetections;
+    amun::SimulatorSetup::PerformanceTier performanceTier;
+    amun::SimulatorSetup::Broadphase broadphase;
+    GroundTruthRecorder groundTruth;
+};
+
+struct camun::simulator::SimulatorSnapshot
+{
+    struct Robot
+    {
+        robot::Specs specs;
+        unsigned int generation;
+        SimRobot::Snapshot state;
+    };
+    typedef QMap<unsigned int, Robot> RobotList;
+
+    RNG rng;
+    uint32_t seed;
+    SimBall::Snapshot ball;
+    RobotList robotsBlue;
+    RobotList robotsYellow;
+    QMap<uint32_t, robot::Specs> specsBlue;
+    QMap<uint32_t, robot::Specs> specsYellow;
+    bool flip;
+    bool charge;
+    // all timestamps are stored relative to the simulation time
+    QList<std::tuple<SSLSimRobotControl, qint64, bool>> radioCommands;
+    QList<std::tuple<QList<QByteArray>, QByteArray, qint64>> visionPackets;
+    qint64 lastSentStatusTime;
+    qint64 lastBallSendTime;
+    std::map<qint64, unsigned> lastFrameNumber;
 };
 
 static void simulatorTickCallback(btDynamicsWorld *world, btScalar timeStep)
@@ -100,6 +180,25 @@ static void simulatorTickCallback(btDynamicsWorld *world, btScalar timeStep)
     sim->handleSimulatorTick(timeStep);
 }
 
+static btBroadphaseInterface *createBroadphase(const amun::SimulatorSetup &setup)
+{
+    if (setup.broadphase() == amun::SimulatorSetup::SWEEP_AND_PRUNE) {
+        // every object is within the field boundary, the goals and the room height (see SimField)
+        // objects outside of the bounds are still handled correctly, but less efficiently
+        const world::Geometry &geometry = setup.geometry();
+        const float margin = 1.0f;
+        const float halfWidth = geometry.field_width() / 2.0f + geometry.boundary_width() + margin;
+        const float halfHeight = geometry.field_height() / 2.0f + geometry.boundary_width()
+                + geometry.goal_depth() + geometry.goal_wall_width() + margin;
+        const float roomHeight = ROOM_HEIGHT + margin;
+        // field, goals, ball and two full teams of robots with dribbler fit easily
+        const unsigned short maxHandles = 256;
+        return new btAxisSweep3(btVector3(-halfWidth, -halfHeight, -margin) * SIMULATOR_SCALE,
+                                btVector3(halfWidth, halfHeight, roomHeight) * SIMULATOR_SCALE, maxHandles);
+    }
+    return new btDbvtBroadphase();
+}
+
 /*!
  * \class Simulator
  * \ingroup simulator
@@ -126,11 +225,18 @@ Simulator::Simulator(const Timer *timer, const amun::SimulatorSetup &setup, bool
         connect(m_trigger, SIGNAL(timeout()), SLOT(process()));
     }
 
+    // delivers the delayed vision packets, always scheduled for the oldest queued packet
+    m_visionTimer = new QTimer(this);
+    m_visionTimer->setTimerType(Qt::PreciseTimer);
+    m_visionTimer->setSingleShot(true);
+    connect(m_visionTimer, SIGNAL(timeout()), SLOT(sendVisionPacket()));
+
     // setup bullet
     m_data = new SimulatorData;
     m_data->collision = new btDefaultCollisionConfiguration();
     m_data->dispatcher = new btCollisionDispatcher(m_data->collision);
-    m_data->overlappingPairCache = new btDbvtBroadphase();
+    m_data->overlappingPairCache = createBroadphase(setup);
+    m_data->broadphase = setup.broadphase();
     m_data->solver = new btSequentialImpulseConstraintSolver;
     m_data->dynamicsWorld = new btDiscreteDynamicsWorld(m_data->dispatcher, m_data->overlappingPairCache, m_data->solver, m_data->collision);
     m_data->dynamicsWorld->setGravity(btVector3(0.0f, 0.0f, -9.81f * SIMULATOR_SCALE));
@@ -148,8 +254,12 @@ Simulator::Simulator(const Timer *timer, const amun::SimulatorSetup &setup, bool
 
     // add field and ball
     m_data->field = new SimField(m_data->dynamicsWorld, m_data->geometry);
-    m_data->ball = new SimBall(&m_data->rng, m_data->dynamicsWorld);
-    connect(m_data->ball, &SimBall::sendSSLSimError, m_aggregator, &ErrorAggregator::aggregate);
+    // only reproducible once seedPRGN is called
+    m_data->seed = m_data->rng.uniformInt();
+    m_data->rng.seed(RNG::streamSeed(m_data->seed, WORLD_NOISE_STREAM));
+    m_data->ball = new SimBall(RNG::streamSeed(m_data->seed, BALL_NOISE_STREAM), m_data->dynamicsWorld);
+    // errors are always aggregated by the thread that runs the simulator, which may not be the one owning the objects
+    connect(m_data->ball, &SimBall::sendSSLSimError, m_aggregator, &ErrorAggregator::aggregate, Qt::DirectConnection);
     m_data->flip = false;
     m_data->stddevBall = 0.0f;
     m_data->stddevBallArea = 0.0f;
@@ -164,16 +274,39 @@ Simulator::Simulator(const Timer *timer, const amun::SimulatorSetup &setup, bool
     m_data->robotReplyPacketLoss = 0;
     m_data->missingBallDetections = 0;
 
+    m_data->performanceTier = setup.performance_tier();
+    m_adaptiveStepping = m_data->performanceTier != amun::SimulatorSetup::EXACT;
+
     // no robots after initialisation
 
     connect(timer, &Timer::scalingChanged, this, &Simulator::setScaling);
 }
 
-// does delete all Simrobots in the RobotMap, does not clear map
+// does delete all Simrobots in the table, does not clear it
 // (just like qDeleteAll would)
-static void deleteAll(const Simulator::RobotMap& map) {
-    for(const auto& e : map) {
-        delete e.first;
+static void deleteAll(const RobotTable& robots) {
+    for(const auto& e : robots) {
+        delete e.robot;
+    }
+}
+
+// keeps the robot for later reuse by createRobot, if the pool is full it is deleted
+static void releaseRobot(SimRobot *robot, SimulatorData *data)
+{
+    // enough for two full teams with different specs each
+    const std::size_t MAX_POOLED_ROBOTS = 32;
+    if (data->robotPool.size() >= MAX_POOLED_ROBOTS) {
+        delete robot;
+        return;
+    }
+    robot->detach();
+    data->robotPool.emplace(robot->specs().SerializeAsString(), robot);
+}
+
+// same as deleteAll, but the robots are released to the pool
+static void releaseAll(const RobotTable& robots, SimulatorData *data) {
+    for(const auto& e : robots) {
+        releaseRobot(e.robot, data);
     }
 }
 
@@ -183,6 +316,9 @@ Simulator::~Simulator()
 
     deleteAll(m_data->robotsBlue);
     deleteAll(m_data->robotsYellow);
+    for (const auto& pooled : m_data->robotPool) {
+        delete pooled.second;
+    }
     delete m_data->ball;
     delete m_data->field;
     delete m_data->dynamicsWorld;
@@ -201,128 +337,187 @@ void Simulator::process()
     const qint64 current_time = m_timer->currentTime();
 
     // first: send vision packets in partial mode
+    // only the packets that are due are handed out, they are received exactly at their scheduled time
+    // thus the latency is the configured vision delay, independent of the step size of the caller
     if (m_isPartial) {
-        while(m_visionPackets.size() > 0 && std::get<2>(m_visionPackets.head()) >= current_time) {
-            sendVisionPacket();
+        while (!m_visionPackets.isEmpty() && std::get<2>(m_visionPackets.head()) <= current_time) {
+            const auto packet = m_visionPackets.dequeue();
+            emitVisionPacket(packet, std::get<2>(packet));
         }
     }
 
-    // collect responses from robots
-    QList<robot::RadioResponse> responses;
-
+    const qint64 radioStartTime = Timer::systemTime();
     // apply only radio commands that were already received by the robots
-    while (m_radioCommands.size() > 0 && std::get<1>(m_radioCommands.head()) < m_time) {
-        RadioCommand commands = m_radioCommands.dequeue();
-        for (const sslsim::RobotCommand& command : std::get<0>(commands)->robot_commands()) {
-
-            if (m_data->robotCommandPacketLoss > 0 && m_data->rng.uniformFloat(0, 1) <= m_data->robotCommandPacketLoss) {
-                continue;
-            }
-
-            // pass radio command to robot that matches the id
-            const auto id = command.id();
-            SimulatorData* data = m_data;
-            auto time = m_time;
-            auto charge = m_charge;
-            auto fabricateResponse = [data, &responses, time, charge, &id, &command](const Simulator::RobotMap& map, const bool* isBlue) {
-                if (!map.contains(id)) return;
-                robot::RadioResponse response = map[id].first->setCommand(command, data->ball, charge,
-                                                                                   data->robotCommandPacketLoss, data->robotReplyPacketLoss);
-                response.set_time(time);
-
-                if (isBlue != nullptr) {
-                    response.set_is_blue(*isBlue);
-                }
-                // only collect valid responses
-                if (response.IsInitialized()) {
-                    if (data->robotReplyPacketLoss == 0 || data->rng.uniformFloat(0, 1) > data->robotReplyPacketLoss) {
-                        responses.append(response);
-                    }
-                }
-            };
-            bool blue = true;
-            if (std::get<2>(commands)) {
-                fabricateResponse(m_data->robotsBlue, &blue);
-            } else {
-                blue = false;
-                fabricateResponse(m_data->robotsYellow, &blue);
+    for (bool isBlue : {false, true}) {
+        for (unsigned id = 0; id < RobotTable::CAPACITY; id++) {
+            const SimulatorData::CommandSlot &slot = m_data->radioCommands[isBlue ? 1 : 0][id];
+            if (slot.valid && slot.receiveTime < m_time) {
+                applyPendingRadioCommand(id, isBlue);
             }
         }
     }
 
     // radio responses are sent when a robot gets his command
     // thus send the responses immediatelly
-    emit sendRadioResponses(responses);
+    emit sendRadioResponses(takeRadioResponses());
+    const qint64 errorStartTime = Timer::systemTime();
+    m_phaseTimings.radioCommands += errorStartTime - radioStartTime;
     sendSSLSimErrorInternal(ErrorSource::BLUE);
     sendSSLSimErrorInternal(ErrorSource::YELLOW);
     sendSSLSimErrorInternal(ErrorSource::CONFIG);
+    const qint64 physicsStartTime = Timer::systemTime();
+    m_phaseTimings.errorAggregation += physicsStartTime - errorStartTime;
 
     // simulate to current strategy time
     double timeDelta = (current_time - m_time) * 1E-9;
+    const bool rollBall = m_adaptiveStepping && isBallIsolated(timeDelta);
+    if (rollBall) {
+        m_data->ball->startRolling();
+    } else {
+        m_data->ball->stopRolling();
+    }
     m_data->dynamicsWorld->stepSimulation(timeDelta, 10, SUB_TIMESTEP);
+    if (rollBall) {
+        m_data->ball->roll(timeDelta);
+    }
+    if (m_adaptiveStepping) {
+        for (const RobotTable *robotList : {&m_data->robotsBlue, &m_data->robotsYellow}) {
+            for (const auto& it : *robotList) {
+                it.robot->trySleep();
+            }
+        }
+    }
     m_time = current_time;
+    const qint64 visionStartTime = Timer::systemTime();
+    m_phaseTimings.physics += visionStartTime - physicsStartTime;
 
     // only send a vision packet every third frame = 15 ms - epsilon (=half frame)
     // gives a vision frequency of 66.67Hz
     if (m_lastSentStatusTime + 12500000 <= m_time) {
+        const qint64 serializationTime = m_phaseTimings.serialization;
         auto data = createVisionPacket();
-
-
-
-        if (m_isPartial) {
-            std::get<2>(data) = m_time + m_visionDelay;
-            m_visionPackets.enqueue(data);
-        } else {
-            m_visionPackets.enqueue(data);
-            // timeout is in milliseconds
-            int timeout = m_visionDelay * 1E-6 / m_timeScaling;
-
-            // send after timeout, default timer mode, may jitter a bit
-            QTimer *timer = new QTimer();
-            timer->setTimerType(Qt::PreciseTimer);
-            timer->setSingleShot(true);
-            connect(timer, SIGNAL(timeout()), SLOT(sendVisionPacket()));
-            timer->start(timeout);
-            m_visionTimers.enqueue(timer);
-        }
+        std::get<2>(data) = m_time + m_visionDelay;
+        enqueueVisionPacket(data);
+        m_phaseTimings.visionPacket += Timer::systemTime() - visionStartTime - (m_phaseTimings.serialization - serializationTime);
 
         m_lastSentStatusTime = m_time;
     }
 
     // send timing information
+    const qint64 endTime = Timer::systemTime();
+    m_phaseTimings.total += endTime - start_time;
+    m_phaseTimings.processCalls++;
     Status status(new amun::Status);
-    status->mutable_timing()->set_simulator((Timer::systemTime() - start_time) * 1E-9f);
+    status->mutable_timing()->set_simulator((endTime - start_time) * 1E-9f);
     emit sendStatus(status);
 }
 
-void Simulator::sendSSLSimErrorInternal(ErrorSource source)
+void Simulator::applyPendingRadioCommand(unsigned id, bool isBlue)
+{
+    SimulatorData::CommandSlot &slot = m_data->radioCommands[isBlue ? 1 : 0][id];
+    slot.valid = false;
+    SimRobot *robot = (isBlue ? m_data->robotsBlue : m_data->robotsYellow).robot(id);
+    if (!robot) {
+        return;
+    }
+    if (m_data->robotCommandPacketLoss > 0 && robot->noise().uniformFloat(0, 1) <= m_data->robotCommandPacketLoss) {
+        return;
+    }
+    applyRadioCommand(slot.command, isBlue);
+}
+
+void Simulator::applyRadioCommand(const sslsim::RobotCommand &command, bool isBlue)
+{
+    // pass radio command to robot that matches the id
+    SimRobot *robot = (isBlue ? m_data->robotsBlue : m_data->robotsYellow).robot(command.id());
+    if (!robot) {
+        return;
+    }
+
+    robot::RadioResponse &response = m_data->scratchResponse;
+    robot->setCommand(command, m_data->ball, m_charge,
+                                 m_data->robotCommandPacketLoss, m_data->robotReplyPacketLoss, &response);
+    response.set_time(m_time);
+    response.set_is_blue(isBlue);
+
+    // only collect valid responses
+    if (!response.IsInitialized()) {
+        return;
+    }
+    if (m_data->robotReplyPacketLoss > 0 && robot->noise().uniformFloat(0, 1) <= m_data->robotReplyPacketLoss) {
+        return;
+    }
+    // only the latest response per robot is kept, the robot exists thus its id is valid
+    SimulatorData::ResponseSlot &slot = m_data->radioResponses[isBlue ? 1 : 0][command.id()];
+    // swapping doesn't allocate, the scratch response is cleared before its next use
+    slot.response.Swap(&response);
+    slot.valid = true;
+}
+
+const QList<robot::RadioResponse> &Simulator::takeRadioResponses()
 {
-    QList<SSLSimError> errors = m_aggregator->getAggregates(source);
-    if (errors.size() == 0) return;
-    emit sendSSLSimError(errors, source);
+    // the buffer only allocates if the number of responses grows
+    // receivers of a previous tick that still hold the list get their own copy on the first write
+    QList<robot::RadioResponse> &responses = m_data->responseBuffer;
+    int count = 0;
+    for (auto &team : m_data->radioResponses) {
+        for (SimulatorData::ResponseSlot &slot : team) {
+            if (slot.valid) {
+                if (count == responses.size()) {
+                    responses.append(robot::RadioResponse());
+                }
+                responses[count++].Swap(&slot.response);
+                slot.valid = false;
+            }
+        }
+    }
+    while (responses.size() > count) {
+        responses.removeLast();
+    }
+    return responses;
 }
 
-static void createRobot(Simulator::RobotMap &list, float x, float y, uint32_t id, const ErrorAggregator* agg, SimulatorData* data, const QMap<uint32_t, robot::Specs>& teamSpecs)
+void Simulator::sendSSLSimErrorInternal(ErrorSource source)
 {
-    SimRobot *robot = new SimRobot(&data->rng, teamSpecs[id], data->dynamicsWorld, btVector3(x, y, 0), 0.f);
-    robot->connect(robot, &SimRobot::sendSSLSimError, agg, &ErrorAggregator::aggregate);
-    list[id] = {robot, teamSpecs[id].generation()};
+    if (m_aggregator->isEmpty(source)) return;
+    m_aggregator->takeAggregates(source, m_errorBuffer);
+    emit sendSSLSimError(m_errorBuffer, source);
+}
 
+static void createRobot(RobotTable &list, float x, float y, const robot::Specs &specs, const ErrorAggregator* agg, SimulatorData* data)
+{
+    const uint32_t seed = RNG::streamSeed(data->seed, robotNoiseStream(&list == &data->robotsBlue, specs.id()));
+    SimRobot *robot;
+    const auto pooled = data->robotPool.find(specs.SerializeAsString());
+    if (pooled != data->robotPool.end()) {
+        robot = pooled->second;
+        data->robotPool.erase(pooled);
+        robot->attach();
+        robot->reset(btVector3(x, y, 0), 0.f);
+        robot->seedNoise(seed);
+    } else {
+        robot = new SimRobot(seed, specs, data->dynamicsWorld, btVector3(x, y, 0), 0.f);
+        robot->connect(robot, &SimRobot::sendSSLSimError, agg, &ErrorAggregator::aggregate, Qt::DirectConnection);
+    }
+    robot->setKinematic(data->performanceTier == amun::SimulatorSetup::KINEMATIC);
+    // the callers only create robots with valid and unused ids
+    const bool inserted = list.insert(specs.id(), robot, specs.generation());
+    Q_ASSERT(inserted);
+    if (!inserted) {
+        releaseRobot(robot, data);
+    }
 }
 
-void Simulator::resetFlipped(Simulator::RobotMap &robots, float side)
+void Simulator::resetFlipped(RobotTable &robots, float side)
 {
     // find flipped robots and align them on a line
     const float x = m_data->geometry.field_width() / 2 - 0.2;
     float y = m_data->geometry.field_height() / 2 - 0.2;
 
-    for (RobotMap::iterator it = robots.begin(); it != robots.end(); ++it) {
-        SimRobot *robot = it.value().first;
+    for (const auto &entry : robots) {
+        SimRobot *robot = entry.robot;
         if (robot->isFlipped()) {
-            SimRobot *new_robot = new SimRobot(&m_data->rng, robot->specs(), m_data->dynamicsWorld, btVector3(x, side * y, 0), 0.0f);
-            delete robot;
-            connect(new_robot, &SimRobot::sendSSLSimError, m_aggregator, &ErrorAggregator::aggregate); // TODO? use createRobot instead of this. However, doing so naively will break the iteration, so I left it for now.
-            it.value().first = new_robot;
+            robot->reset(btVector3(x, side * y, 0), 0.0f);
         }
         y -= 0.3;
     }
@@ -336,18 +531,18 @@ void Simulator::handleSimulatorTick(double timeStep)
     resetFlipped(m_data->robotsBlue, 1.0f);
     resetFlipped(m_data->robotsYellow, -1.0f);
     if (m_data->ball->isInvalid()) {
-        delete m_data->ball;
-        m_data->ball = new SimBall(&m_data->rng, m_data->dynamicsWorld);
-        connect(m_data->ball, &SimBall::sendSSLSimError, m_aggregator, &ErrorAggregator::aggregate);
+        m_data->ball->reset();
     }
 
     // apply commands and forces to ball and robots
+    // sleeping idle robots stay untouched until they get a command or are hit
     m_data->ball->begin();
-    for(const auto& pair : m_data->robotsBlue) {
-        pair.first->begin(m_data->ball, timeStep);
-    }
-    for(const auto& pair : m_data->robotsYellow) {
-        pair.first->begin(m_data->ball, timeStep);
+    for (const RobotTable *team : {&m_data->robotsBlue, &m_data->robotsYellow}) {
+        for (const auto& entry : *team) {
+            if (!m_adaptiveStepping || !entry.robot->isSleeping() || !entry.robot->isIdle()) {
+                entry.robot->begin(m_data->ball, timeStep);
+            }
+        }
     }
 
     // add gravity to all ACTIVE objects
@@ -355,19 +550,32 @@ void Simulator::handleSimulatorTick(double timeStep)
     m_data->dynamicsWorld->applyGravity();
 }
 
-static bool checkCameraID(const int cameraId, const btVector3 &p, const QVector<btVector3> &cameraPositions, const float overlap)
+// Determines which cameras see the objects of the given assignment. An object is visible for every camera
+// which is at most 2 * overlap farther away than the nearest camera.
+static void computeCameraVisibility(SimulatorData::CameraAssignment &assignment, const QVector<btVector3> &cameraPositions, const float overlap)
 {
-    float minDistance = std::numeric_limits<float>::max();
-    float ownDistance = 0;
-    for (int i = 0;i<cameraPositions.size();i++) {
-        // manhattan distance for rectangular camera regions (if the cameras are distributed normally)
-        float distance = std::abs(cameraPositions[i].x() - p.x()) + std::abs(cameraPositions[i].y() - p.y());
-        minDistance = std::min(minDistance, distance);
-        if (i == cameraId) {
-            ownDistance = distance;
+    const std::size_t numObjects = assignment.objectsX.size();
+    const std::size_t numCameras = cameraPositions.size();
+    const float *xs = assignment.objectsX.data();
+    const float *ys = assignment.objectsY.data();
+    assignment.distances.resize(numCameras * numObjects);
+    assignment.minDistance.assign(numObjects, std::numeric_limits<float>::max());
+    float *minDistance = assignment.minDistance.data();
+    for (std::size_t cameraId = 0; cameraId < numCameras; ++cameraId) {
+        const float cameraX = cameraPositions[cameraId].x();
+        const float cameraY = cameraPositions[cameraId].y();
+        float *cameraDistances = assignment.distances.data() + cameraId * numObjects;
+        for (std::size_t i = 0; i < numObjects; ++i) {
+            // manhattan distance for rectangular camera regions (if the cameras are distributed normally)
+            cameraDistances[i] = std::abs(cameraX - xs[i]) + std::abs(cameraY - ys[i]);
+            minDistance[i] = std::min(minDistance[i], cameraDistances[i]);
         }
     }
-    return ownDistance <= minDistance + 2 * overlap;
+
+    assignment.visible.resize(numCameras * numObjects);
+    for (std::size_t j = 0; j < numCameras * numObjects; ++j) {
+        assignment.visible[j] = assignment.distances[j] <= minDistance[j % numObjects] + 2 * overlap;
+    }
 }
 
 void Simulator::initializeDetection(SSL_DetectionFrame *detection, std::size_t cameraId)
@@ -381,6 +589,10 @@ void Simulator::initializeDetection(SSL_DetectionFrame *detection, std::size_t c
 std::tuple<QList<QByteArray>, QByteArray, qint64> Simulator::createVisionPacket()
 {
     const std::size_t numCameras = m_data->reportedCameraSetup.size();
+    // the ground truth is only collected if anyone is interested in it
+    const bool sendTruth = isSignalConnected(QMetaMethod::fromSignal(&Simulator::sendRealData));
+    const bool recordTruth = m_data->groundTruth.wantsFrame();
+    const bool needsTruth = sendTruth || recordTruth;
     world::SimulatorState simState;
 
     std::vector<SSL_DetectionFrame> detections(numCameras);
@@ -388,18 +600,37 @@ std::tuple<QList<QByteArray>, QByteArray, qint64> Simulator::createVisionPacket(
         initializeDetection(&detections[i], i);
     }
 
-    auto* ball = simState.mutable_ball();
-    m_data->ball->writeBallState(ball);
+    if (needsTruth) {
+        m_data->ball->writeBallState(simState.mutable_ball());
+    }
 
-    bool missingBall = m_data->missingBallDetections > 0 && m_data->rng.uniformFloat(0, 1) <= m_data->missingBallDetections;
+    // camera assignment for all objects at once
+    SimulatorData::CameraAssignment &assignment = m_data->cameraAssignment;
+    const std::size_t numObjects = 1 + m_data->robotsBlue.size() + m_data->robotsYellow.size();
+    assignment.objectsX.clear();
+    assignment.objectsY.clear();
     const btVector3 ballPosition = m_data->ball->position() / SIMULATOR_SCALE;
+    assignment.objectsX.push_back(ballPosition.x());
+    assignment.objectsY.push_back(ballPosition.y());
+    for (const RobotTable *team : {&m_data->robotsBlue, &m_data->robotsYellow}) {
+        for (const auto& it : *team) {
+            const btVector3 robotPos = it.robot->position() / SIMULATOR_SCALE;
+            assignment.objectsX.push_back(robotPos.x());
+            assignment.objectsY.push_back(robotPos.y());
+        }
+    }
+    computeCameraVisibility(assignment, m_data->cameraPositions, m_data->cameraOverlap);
+    const std::vector<char> &visible = assignment.visible;
+
+    // the noisy detections are generated sequentially to keep the random number sequence stable
+    bool missingBall = m_data->missingBallDetections > 0 && m_data->rng.uniformFloat(0, 1) <= m_data->missingBallDetections;
     if (m_time - m_lastBallSendTime >= m_minBallDetectionTime && !missingBall) {
         m_lastBallSendTime = m_time;
 
 
         for (std::size_t cameraId = 0; cameraId < numCameras; ++cameraId) {
             // at least one id is always valid
-            if (!checkCameraID(cameraId, ballPosition, m_data->cameraPositions, m_data->cameraOverlap)) {
+            if (!visible[cameraId * numObjects]) {
                 continue;
             }
 
@@ -413,22 +644,24 @@ std::tuple<QList<QByteArray>, QByteArray, qint64> Simulator::createVisionPacket(
     }
 
     // get robot positions
+    std::size_t objectIndex = 1;
     for (bool teamIsBlue : {true, false}) {
         auto &team = teamIsBlue ? m_data->robotsBlue : m_data->robotsYellow;
 
         for (const auto& it : team) {
-            SimRobot* robot = it.first;
-            auto* robotProto = teamIsBlue ? simState.add_blue_robots() : simState.add_yellow_robots();
-            robot->update(robotProto);
+            SimRobot* robot = it.robot;
+            const std::size_t robotIndex = objectIndex++;
+            if (needsTruth) {
+                robot->update(teamIsBlue ? simState.add_blue_robots() : simState.add_yellow_robots());
+            }
 
             if (m_time - robot->getLastSendTime() >= m_minRobotDetectionTime) {
                 const float timeDiff = (m_time - robot->getLastSendTime()) * 1E-9;
-                const btVector3 robotPos = robot->position() / SIMULATOR_SCALE;
 
                 for (std::size_t cameraId = 0; cameraId < numCameras; ++cameraId) {
 
 
-                    if (!checkCameraID(cameraId, robotPos, m_data->cameraPositions, m_data->cameraOverlap)) {
+                    if (!visible[cameraId * numObjects + robotIndex]) {
                         continue;
                     }
 
@@ -442,7 +675,7 @@ std::tuple<QList<QByteArray>, QByteArray, qint64> Simulator::createVisionPacket(
                     // once in a while, add a ball mis-detection at a corner of the dribbler
                     // in real games, this happens because the ball detection light beam used by many teams is red
                     float detectionProb = timeDiff * m_data->ballDetectionsAtDribbler;
-                    if (m_data->ballDetectionsAtDribbler > 0 && m_data->rng.uniformFloat(0, 1) < detectionProb) {
+                    if (m_data->ballDetectionsAtDribbler > 0 && robot->noise().uniformFloat(0, 1) < detectionProb) {
                         // always on the right side of the dribbler for now
                         if (!m_data->ball->addDetection(detections[cameraId].add_balls(), robot->dribblerCorner(false) / SIMULATOR_SCALE,
                                                         m_data->stddevRobot, 0, m_data->cameraPositions[cameraId], false, 0)) {
@@ -466,9 +699,8 @@ std::tuple<QList<QByteArray>, QByteArray, qint64> Simulator::createVisionPacket(
             std::random_shuffle(frame.mutable_balls()->begin(), frame.mutable_balls()->end());
         }
 
-        SSL_WrapperPacket packet;
-        packet.mutable_detection()->CopyFrom(frame);
-        packets.push_back(packet);
+        packets.emplace_back();
+        packets.back().mutable_detection()->Swap(&frame);
     }
 
     // add field geometry
@@ -498,7 +730,12 @@ std::tuple<QList<QByteArray>, QByteArray, qint64> Simulator::createVisionPacket(
     geometry->mutable_models()->mutable_chip_fixed_loss()->set_damping_xy_first_hop(0.715);
     geometry->mutable_models()->mutable_chip_fixed_loss()->set_damping_xy_other_hops(1);
 
+    if (recordTruth) {
+        m_data->groundTruth.record(m_time, simState);
+    }
+
     // serialize "vision packet"
+    const qint64 serializationStartTime = Timer::systemTime();
     QList<QByteArray> data;
     for (std::size_t i = 0; i < packets.size(); ++i) {
         QByteArray d;
@@ -511,45 +748,91 @@ std::tuple<QList<QByteArray>, QByteArray, qint64> Simulator::createVisionPacket(
     }
 
     QByteArray d;
-    d.resize(simState.ByteSize());
-    if (!simState.SerializeToArray(d.data(), d.size())) {
-        d = {};
+    if (sendTruth) {
+        d.resize(simState.ByteSize());
+        if (!simState.SerializeToArray(d.data(), d.size())) {
+            d = {};
+        }
     }
-    return {data,d, 0};
+    m_phaseTimings.serialization += Timer::systemTime() - serializationStartTime;
+    return {data, d, 0};
 }
 
-void Simulator::sendVisionPacket()
+void Simulator::enqueueVisionPacket(const std::tuple<QList<QByteArray>, QByteArray, qint64> &packet)
 {
-    auto currentVisionPackets = m_visionPackets.dequeue();
-    for (const QByteArray &data : std::get<0>(currentVisionPackets)) {
-        emit gotPacket(data, m_timer->currentTime(), "simulator"); // send "vision packet" and assume instant receiving
-        // the receive time may be a bit jittered just like a real transmission
+    // the vision delay may have been lowered in the meantime, keep the queue ordered
+    auto it = m_visionPackets.end();
+    while (it != m_visionPackets.begin() && std::get<2>(*(it - 1)) > std::get<2>(packet)) {
+        --it;
+    }
+    const bool isFirst = it == m_visionPackets.begin();
+    m_visionPackets.insert(it, packet);
+    if (isFirst) {
+        scheduleVisionPacket();
+    }
+}
 
+void Simulator::emitVisionPacket(const std::tuple<QList<QByteArray>, QByteArray, qint64> &packet, qint64 receiveTime)
+{
+    for (const QByteArray &data : std::get<0>(packet)) {
+        emit gotPacket(data, receiveTime, "simulator"); // send "vision packet" and assume instant receiving
     }
-    emit sendRealData(std::get<1>(currentVisionPackets));
-    if (!m_isPartial) {
-        QTimer *timer = m_visionTimers.dequeue();
-        timer->deleteLater();
+    emit sendRealData(std::get<1>(packet));
+}
+
+void Simulator::sendVisionPacket()
+{
+    // the timer may fire late, deliver every packet that is due
+    // packets are received exactly at their delivery time, independent of the timer jitter
+    const qint64 now = m_timer->currentTime();
+    while (!m_visionPackets.isEmpty() && std::get<2>(m_visionPackets.head()) <= now) {
+        const auto packet = m_visionPackets.dequeue();
+        emitVisionPacket(packet, std::get<2>(packet));
+    }
+    scheduleVisionPacket();
+}
+
+void Simulator::scheduleVisionPacket()
+{
+    if (m_isPartial || m_visionPackets.isEmpty() || !m_enabled || m_timeScaling <= 0) {
+        m_visionTimer->stop();
+        return;
     }
+    const qint64 remaining = std::get<2>(m_visionPackets.head()) - m_timer->currentTime();
+    // timeout is in milliseconds
+    m_visionTimer->start(qMax(0, (int)std::ceil(remaining * 1E-6 / m_timeScaling)));
 }
 
 void Simulator::resetVisionPackets()
 {
-    qDeleteAll(m_visionTimers);
-    m_visionTimers.clear();
+    m_visionTimer->stop();
     m_visionPackets.clear();
 }
 
 void Simulator::handleRadioCommands(const SSLSimRobotControl &commands, bool isBlue, qint64 processingStart)
 {
-    m_radioCommands.enqueue(std::make_tuple(commands, processingStart, isBlue));
+    for (const sslsim::RobotCommand &command : commands->robot_commands()) {
+        // no robot can have such an id
+        if (!RobotTable::isValidId(command.id())) {
+            continue;
+        }
+        // a pending command that is already due would be applied right before the new one,
+        // otherwise both would be applied by the same process call and only the new one has an effect
+        SimulatorData::CommandSlot &slot = m_data->radioCommands[isBlue ? 1 : 0][command.id()];
+        if (slot.valid && slot.receiveTime < m_time) {
+            applyPendingRadioCommand(command.id(), isBlue);
+        }
+        slot.command.CopyFrom(command);
+        slot.receiveTime = processingStart;
+        slot.valid = true;
+    }
 }
 
 
-void Simulator::setTeam(Simulator::RobotMap &list, float side, const robot::Team &team, QMap<uint32_t, robot::Specs>& teamSpecs)
+void Simulator::setTeam(RobotTable &list, float side, const robot::Team &team, QMap<uint32_t, robot::Specs>& teamSpecs)
 {
     // remove old team
-    deleteAll(list);
+    releaseAll(list, m_data);
     list.clear();
 
     // changing a team is also triggering a tracking reset
@@ -568,6 +851,10 @@ void Simulator::setTeam(Simulator::RobotMap &list, float side, const robot::Team
         const robot::Specs& specs = team.robot(i);
         const auto id = specs.id();
 
+        if (!RobotTable::isValidId(id)) {
+            std::cerr << "Error: Robot id " << id << " is out of range, aborting!" << std::endl;
+            continue;
+        }
         // (color, robot id) must be unique
         if (list.contains(id)) {
             std::cerr << "Error: Two ids for the same color, aborting!" << std::endl;
@@ -577,7 +864,7 @@ void Simulator::setTeam(Simulator::RobotMap &list, float side, const robot::Team
 
 
 
-        createRobot(list, x, side * y, id, m_aggregator, m_data, teamSpecs);
+        createRobot(list, x, side * y, teamSpecs[id], m_aggregator, m_data);
         y -= 0.3;
     }
 }
@@ -615,7 +902,7 @@ void Simulator::moveRobot(const sslsim::TeleportRobot &robot) {
     if (!robot.id().has_id()) return;
     bool is_blue = robot.id().team() == gameController::Team::BLUE;
 
-    RobotMap& list = is_blue ? m_data->robotsBlue : m_data->robotsYellow;
+    RobotTable& list = is_blue ? m_data->robotsBlue : m_data->robotsYellow;
     bool isPresent = list.contains(robot.id().id());
     QMap<uint32_t, robot::Specs>& teamSpecs = is_blue ? m_data->specsBlue : m_data->specsYellow;
     if (robot.has_present()) {
@@ -639,13 +926,12 @@ void Simulator::moveRobot(const sslsim::TeleportRobot &robot) {
                 Vector targetPos;
                 coordinates::fromVision(robot, targetPos);
                 //TODO: check if the given position is fine
-                createRobot(list, targetPos.x, targetPos.y, robot.id().id(), m_aggregator, m_data, teamSpecs);
+                createRobot(list, targetPos.x, targetPos.y, teamSpecs[robot.id().id()], m_aggregator, m_data);
             }
         }
         else if (!robot.present() && isPresent) {
             //remove the robot
-            auto val = list.take(robot.id().id());
-            delete val.first;
+            releaseRobot(list.take(robot.id().id()), m_data);
             return;
         }
         else if (!robot.present() && !isPresent) {
@@ -668,7 +954,7 @@ void Simulator::moveRobot(const sslsim::TeleportRobot &robot) {
         FLIP(r, v_y);
     }
 
-    SimRobot* sim_robot = list[robot.id().id()].first;
+    SimRobot* sim_robot = list.robot(robot.id().id());
     sim_robot->move(r);
 }
 
@@ -747,9 +1033,9 @@ void Simulator::handleCommand(const Command &command)
             }
 
             if (realism.has_simulate_dribbling()) {
-                for (const auto& robotList : {m_data->robotsBlue, m_data->robotsYellow}) {
-                    for (const auto& it : robotList) {
-                        SimRobot *robot = it.first;
+                for (const RobotTable *robotList : {&m_data->robotsBlue, &m_data->robotsYellow}) {
+                    for (const auto& it : *robotList) {
+                        SimRobot *robot = it.robot;
                         robot->setDribbleMode(!realism.simulate_dribbling());
                     }
                 }
@@ -766,6 +1052,16 @@ void Simulator::handleCommand(const Command &command)
             }
         }
 
+        if (sim.has_ground_truth_export()) {
+            QString message;
+            if (!m_data->groundTruth.configure(sim.ground_truth_export(), message)) {
+                SSLSimError error{new sslsim::SimulatorError};
+                error->set_code("GROUND_TRUTH_EXPORT");
+                error->set_message("could not open ground truth export: " + message.toStdString());
+                m_aggregator->aggregate(error, ErrorSource::CONFIG);
+            }
+        }
+
         if (sim.has_vision_worst_case()) {
             if (sim.vision_worst_case().has_min_ball_detection_time()) {
                 m_minBallDetectionTime = sim.vision_worst_case().min_ball_detection_time() * 1E9;
@@ -779,10 +1075,10 @@ void Simulator::handleCommand(const Command &command)
             if (sim.set_simulator_state().has_ball()) {
                 m_data->ball->restoreState(sim.set_simulator_state().ball());
             }
-            const auto restoreRobots = [](RobotMap& map, auto robots) {
+            const auto restoreRobots = [](RobotTable& map, auto robots) {
                 for(const auto& robot: robots) {
-                    if (map.contains(robot.id())) {
-                        map[robot.id()].first->restoreState(robot);
+                    if (SimRobot *simRobot = map.robot(robot.id())) {
+                        simRobot->restoreState(robot);
                     }
                 }
             };
@@ -809,6 +1105,8 @@ void Simulator::handleCommand(const Command &command)
 
 void Simulator::setScaling(double scaling)
 {
+    // needed if scaling is set before simulator was enabled
+    m_timeScaling = scaling;
     if (scaling <= 0 || !m_enabled) {
         m_trigger->stop();
         // clear pending vision packets
@@ -818,20 +1116,159 @@ void Simulator::setScaling(double scaling)
         const int t = 5 / scaling;
         m_trigger->start(qMax(1, t));
 
-        // The vision packet timings are wrong after a scaling change
-        // In addition if the new scaling is larger than the old one,
-        // this would cause the timers started after the scaling change
-        // to trigger before the old timers, what causes the deletion of
-        // the old timers before they are fired.
-        resetVisionPackets();
+        // packets are keyed on the simulation time, only the timeout has to be adapted
+        scheduleVisionPacket();
     }
-    // needed if scaling is set before simulator was enabled
-    m_timeScaling = scaling;
 }
 
 void Simulator::seedPRGN(uint32_t seed)
 {
-    m_data->rng.seed(seed);
+    m_data->seed = seed;
+    m_data->rng.seed(RNG::streamSeed(seed, WORLD_NOISE_STREAM));
+    m_data->ball->seedNoise(RNG::streamSeed(seed, BALL_NOISE_STREAM));
+    for (bool isBlue : {true, false}) {
+        for (const auto &entry : isBlue ? m_data->robotsBlue : m_data->robotsYellow) {
+            entry.robot->seedNoise(RNG::streamSeed(seed, robotNoiseStream(isBlue, entry.id)));
+        }
+    }
+}
+
+std::shared_ptr<const SimulatorSnapshot> Simulator::createSnapshot() const
+{
+    auto snapshot = std::make_shared<SimulatorSnapshot>();
+    snapshot->rng = m_data->rng;
+    snapshot->seed = m_data->seed;
+    snapshot->ball = m_data->ball->snapshot();
+    const auto saveRobots = [this](const RobotTable &robots, SimulatorSnapshot::RobotList &list) {
+        for (const auto &entry : robots) {
+            SimRobot::Snapshot state = entry.robot->snapshot();
+            state.lastSendTime -= m_time;
+            list[entry.id] = {entry.robot->specs(), entry.generation, state};
+        }
+    };
+    saveRobots(m_data->robotsBlue, snapshot->robotsBlue);
+    saveRobots(m_data->robotsYellow, snapshot->robotsYellow);
+    snapshot->specsBlue = m_data->specsBlue;
+    snapshot->specsYellow = m_data->specsYellow;
+    snapshot->flip = m_data->flip;
+    snapshot->charge = m_charge;
+
+    for (bool isBlue : {false, true}) {
+        for (const SimulatorData::CommandSlot &slot : m_data->radioCommands[isBlue ? 1 : 0]) {
+            if (slot.valid) {
+                SSLSimRobotControl control(new sslsim::RobotControl);
+                control->add_robot_commands()->CopyFrom(slot.command);
+                snapshot->radioCommands.append(std::make_tuple(control, slot.receiveTime - m_time, isBlue));
+            }
+        }
+    }
+    for (const auto &packet : m_visionPackets) {
+        snapshot->visionPackets.append(std::make_tuple(std::get<0>(packet), std::get<1>(packet), std::get<2>(packet) - m_time));
+    }
+    snapshot->lastSentStatusTime = m_lastSentStatusTime - m_time;
+    snapshot->lastBallSendTime = m_lastBallSendTime - m_time;
+    snapshot->lastFrameNumber = m_lastFrameNumber;
+    return snapshot;
+}
+
+void Simulator::restoreSnapshot(const SimulatorSnapshot &snapshot)
+{
+    const qint64 now = m_timer->currentTime();
+
+    m_data->rng = snapshot.rng;
+    // robots created later on get the same noise as in the original simulator
+    m_data->seed = snapshot.seed;
+    m_data->ball->restoreSnapshot(snapshot.ball);
+
+    // reuse robots with identical specs, the bodies are overwritten anyway
+    const auto restoreRobots = [this, now](RobotTable &robots, const SimulatorSnapshot::RobotList &list) {
+        for (unsigned id = 0; id < RobotTable::CAPACITY; id++) {
+            const RobotTable::Entry *entry = robots.find(id);
+            if (!entry) {
+                continue;
+            }
+            const auto saved = list.find(id);
+            if (saved == list.end() || saved->specs.SerializeAsString() != entry->robot->specs().SerializeAsString()) {
+                releaseRobot(robots.take(id), m_data);
+            }
+        }
+        for (auto it = list.begin(); it != list.end(); ++it) {
+            if (!robots.contains(it.key())) {
+                createRobot(robots, 0, 0, it->specs, m_aggregator, m_data);
+            }
+            RobotTable::Entry *entry = robots.find(it.key());
+            entry->generation = it->generation;
+            entry->robot->restoreSnapshot(it->state, m_data->ball, now);
+        }
+    };
+    restoreRobots(m_data->robotsBlue, snapshot.robotsBlue);
+    restoreRobots(m_data->robotsYellow, snapshot.robotsYellow);
+    m_data->specsBlue = snapshot.specsBlue;
+    m_data->specsYellow = snapshot.specsYellow;
+    m_data->flip = snapshot.flip;
+    m_charge = snapshot.charge;
+
+    // cached contacts of the previous state would otherwise influence the next simulation step
+    btCollisionObjectArray &objects = m_data->dynamicsWorld->getCollisionObjectArray();
+    for (int i = 0; i < objects.size(); i++) {
+        m_data->overlappingPairCache->getOverlappingPairCache()->cleanProxyFromPairs(objects[i]->getBroadphaseHandle(), m_data->dispatcher);
+    }
+    m_data->solver->reset();
+
+    m_time = now;
+    for (auto &team : m_data->radioCommands) {
+        for (SimulatorData::CommandSlot &slot : team) {
+            slot.valid = false;
+        }
+    }
+    // there is at most one command per robot, thus none of them is applied immediately
+    for (const auto &command : snapshot.radioCommands) {
+        handleRadioCommands(std::get<0>(command), std::get<2>(command), std::get<1>(command) + m_time);
+    }
+    resetVisionPackets();
+    for (const auto &packet : snapshot.visionPackets) {
+        m_visionPackets.enqueue(std::make_tuple(std::get<0>(packet), std::get<1>(packet), std::get<2>(packet) + m_time));
+    }
+    scheduleVisionPacket();
+    m_lastSentStatusTime = snapshot.lastSentStatusTime + m_time;
+    m_lastBallSendTime = snapshot.lastBallSendTime + m_time;
+    m_lastFrameNumber = snapshot.lastFrameNumber;
+}
+
+std::unique_ptr<Simulator> Simulator::fork(const Timer *timer) const
+{
+    amun::SimulatorSetup setup;
+    setup.mutable_geometry()->CopyFrom(m_data->geometry);
+    for (const auto &camera : m_data->reportedCameraSetup) {
+        setup.add_camera_setup()->CopyFrom(camera);
+    }
+    setup.set_performance_tier(m_data->performanceTier);
+    setup.set_broadphase(m_data->broadphase);
+
+    std::unique_ptr<Simulator> sim(new Simulator(timer, setup, m_isPartial));
+    SimulatorData *data = sim->m_data;
+    data->stddevBall = m_data->stddevBall;
+    data->stddevBallArea = m_data->stddevBallArea;
+    data->stddevRobot = m_data->stddevRobot;
+    data->stddevRobotPhi = m_data->stddevRobotPhi;
+    data->ballDetectionsAtDribbler = m_data->ballDetectionsAtDribbler;
+    data->enableInvisibleBall = m_data->enableInvisibleBall;
+    data->ballVisibilityThreshold = m_data->ballVisibilityThreshold;
+    data->cameraOverlap = m_data->cameraOverlap;
+    data->cameraPositionError = m_data->cameraPositionError;
+    data->robotCommandPacketLoss = m_data->robotCommandPacketLoss;
+    data->robotReplyPacketLoss = m_data->robotReplyPacketLoss;
+    data->missingBallDetections = m_data->missingBallDetections;
+    sim->m_visionDelay = m_visionDelay;
+    sim->m_visionProcessingTime = m_visionProcessingTime;
+    sim->m_minRobotDetectionTime = m_minRobotDetectionTime;
+    sim->m_minBallDetectionTime = m_minBallDetectionTime;
+    sim->m_adaptiveStepping = m_adaptiveStepping;
+
+    sim->m_enabled = m_enabled;
+    sim->setScaling(m_timeScaling);
+    sim->restoreSnapshot(*createSnapshot());
+    return sim;
 }
 
 static bool overlapCheck(const btVector3& p0, const float& r0, const btVector3& p1, const float& r1)
@@ -840,6 +1277,40 @@ static bool overlapCheck(const btVector3& p0, const float& r0, const btVector3&
     return distance <= r0+r1;
 }
 
+// checks whether the ball can't touch anything but the floor during the next timeDelta seconds
+bool Simulator::isBallIsolated(double timeDelta) const
+{
+    // additional distance to keep, covers acceleration during the time step
+    const float ISOLATION_MARGIN = 0.1f;
+
+    const SimBall *ball = m_data->ball;
+    // the sliding phase after a kick is left to bullet
+    if (!ball->isRolling() && !ball->isRollingWithoutSlip()) {
+        return false;
+    }
+    const btVector3 ballPos = ball->position() / SIMULATOR_SCALE;
+    const float ballTravel = ball->speed().length() / SIMULATOR_SCALE * timeDelta;
+
+    // stay inside the field lines, the goals and field walls are outside
+    const float maxX = m_data->geometry.field_width() / 2 - ballTravel - ISOLATION_MARGIN;
+    const float maxY = m_data->geometry.field_height() / 2 - ballTravel - ISOLATION_MARGIN;
+    if (std::abs(ballPos.x()) > maxX || std::abs(ballPos.y()) > maxY) {
+        return false;
+    }
+
+    for (const RobotTable *robotList : {&m_data->robotsBlue, &m_data->robotsYellow}) {
+        for (const auto& it : *robotList) {
+            const SimRobot *robot = it.robot;
+            const float robotTravel = robot->speed().length() / SIMULATOR_SCALE * timeDelta;
+            if (overlapCheck(ballPos, BALL_RADIUS + ballTravel + ISOLATION_MARGIN,
+                             robot->position() / SIMULATOR_SCALE, robot->specs().radius() + robotTravel)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 // uses the real world scale
 void Simulator::teleportRobotToFreePosition(SimRobot *robot)
 {
@@ -851,9 +1322,9 @@ void Simulator::teleportRobotToFreePosition(SimRobot *robot)
         valid = true;
         robotPos = robotPos + 2 * direction*distance;
 
-        for (const auto& robotList : {m_data->robotsBlue, m_data->robotsYellow}) {
-            for (const auto& it : robotList) {
-                SimRobot *robot2 = it.first;
+        for (const RobotTable *robotList : {&m_data->robotsBlue, &m_data->robotsYellow}) {
+            for (const auto& it : *robotList) {
+                SimRobot *robot2 = it.robot;
                 if (robot == robot2) {
                     continue;
                 }
@@ -885,9 +1356,9 @@ void Simulator::safelyTeleportBall(const float x, const float y)
     const float STOP_ROBOTS_RADIUS = 1.5f;
 
     btVector3 newBallPos(x, y, 0);
-    for (const auto& robotList : {m_data->robotsBlue, m_data->robotsYellow}) {
-        for (const auto& it : robotList) {
-            SimRobot* robot = it.first;
+    for (const RobotTable *robotList : {&m_data->robotsBlue, &m_data->robotsYellow}) {
+        for (const auto& it : *robotList) {
+            SimRobot* robot = it.robot;
             btVector3 robotPos = robot->position() / SIMULATOR_SCALE;
             if (overlapCheck(newBallPos, BALL_RADIUS, robotPos, robot->specs().radius())) {
                 teleportRobotToFreePosition(robot);
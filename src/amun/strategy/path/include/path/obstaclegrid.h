@@ -0,0 +1,106 @@
+/***************************************************************************
+ *   Copyright 2021                                                        *
+ *   Robotics Erlangen e.V.                                                *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef OBSTACLEGRID_H
+#define OBSTACLEGRID_H
+
+#include "obstacles.h"
+#include <QVector>
+#include <algorithm>
+#include <vector>
+
+// uniform grid over the bounding boxes of the static obstacles
+// every obstacle is stored in all cells its bounding box touches
+class ObstacleGrid
+{
+public:
+    void build(const QVector<const StaticObstacles::Obstacle*> &obstacles);
+    // calls visitor(obstacle) once for every obstacle whose bounding box intersects the box, in no particular order
+    // the visitor returns false to stop the search, this does not allocate any memory
+    template<typename Visitor>
+    void visit(BoundingBox box, Visitor visitor) const;
+
+private:
+    void cellRange(const BoundingBox &box, int &x0, int &y0, int &x1, int &y1) const;
+
+private:
+    static constexpr int MAX_CELLS_PER_AXIS = 32;
+    static constexpr float MIN_CELL_SIZE = 0.25f;
+    // obstacles covering more cells are checked for every query instead
+    static constexpr int MAX_CELLS_PER_OBSTACLE = 64;
+
+    std::vector<const StaticObstacles::Obstacle*> m_obstacles;
+    std::vector<BoundingBox> m_boxes;
+    BoundingBox m_area = BoundingBox(Vector(0, 0), Vector(0, 0));
+    float m_cellSize = 1;
+    int m_width = 0;
+    int m_height = 0;
+    // obstacle indices of all cells, the cell i uses the range [m_cellStart[i], m_cellStart[i+1])
+    std::vector<int> m_cellStart;
+    std::vector<int> m_cellObstacles;
+    std::vector<int> m_largeObstacles;
+    // lowest cell coordinates of every obstacle, used to report obstacles spanning multiple cells only once
+    std::vector<int> m_firstColumn;
+    std::vector<int> m_firstRow;
+};
+
+inline void ObstacleGrid::cellRange(const BoundingBox &box, int &x0, int &y0, int &x1, int &y1) const
+{
+    x0 = std::max(0, std::min(m_width - 1, int((box.left - m_area.left) / m_cellSize)));
+    x1 = std::max(0, std::min(m_width - 1, int((box.right - m_area.left) / m_cellSize)));
+    y0 = std::max(0, std::min(m_height - 1, int((box.bottom - m_area.bottom) / m_cellSize)));
+    y1 = std::max(0, std::min(m_height - 1, int((box.top - m_area.bottom) / m_cellSize)));
+}
+
+template<typename Visitor>
+void ObstacleGrid::visit(BoundingBox box, Visitor visitor) const
+{
+    if (m_obstacles.empty() || !box.intersects(m_area)) {
+        return;
+    }
+
+    for (int i : m_largeObstacles) {
+        BoundingBox obstacleBox = m_boxes[i];
+        if (obstacleBox.intersects(box) && !visitor(m_obstacles[i])) {
+            return;
+        }
+    }
+
+    int x0, y0, x1, y1;
+    cellRange(box, x0, y0, x1, y1);
+    for (int y = y0;y<=y1;y++) {
+        for (int x = x0;x<=x1;x++) {
+            const int cell = y * m_width + x;
+            for (int c = m_cellStart[cell];c<m_cellStart[cell + 1];c++) {
+                const int i = m_cellObstacles[c];
+                // an obstacle spanning multiple cells is only reported in the first cell it shares with the box
+                if (x != std::max(x0, m_firstColumn[i]) || y != std::max(y0, m_firstRow[i])) {
+                    continue;
+                }
+                BoundingBox obstacleBox = m_boxes[i];
+                if (obstacleBox.intersects(box) && !visitor(m_obstacles[i])) {
+                    return;
+                }
+            }
+        }
+    }
+}
+
+#endif // OBSTACLEGRID_H
@@ -87,7 +87,6 @@ namespace StaticObstacles {
 
         void serializeChild(pathfinding::Obstacle *obstacle) const override;
 
-    private:
         Vector center;
     };
 
@@ -0,0 +1,57 @@
+/***************************************************************************
+ *   Copyright 2021                                                        *
+ *   Robotics Erlangen e.V.                                                *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef STATICOBSTACLEARRAYS_H
+#define STATICOBSTACLEARRAYS_H
+
+#include "obstacles.h"
+#include <vector>
+
+// copy of the static obstacles of a world with one array per parameter and obstacle type
+// the point queries run over all obstacles of a type in a plain loop without virtual calls
+class StaticObstacleArrays
+{
+public:
+    void build(const std::vector<StaticObstacles::Circle> &circles, const std::vector<StaticObstacles::Rect> &rects,
+               const std::vector<StaticObstacles::Triangle> &triangles, const std::vector<StaticObstacles::Line> &lines);
+    // same as checking distance(point) < 0 for every obstacle
+    bool isInObstacle(Vector point) const;
+    // minimum of distance(point) over all obstacles, the maximum float value if there are none
+    float minDistance(Vector point) const;
+
+private:
+    float minCircleDistance(Vector point) const;
+    float minRectDistance(Vector point) const;
+    float minLineDistance(Vector point) const;
+
+    struct Circles {
+        std::vector<float> x, y, radius;
+    } m_circles;
+    struct Rects {
+        std::vector<float> left, bottom, right, top, radius;
+    } m_rects;
+    struct Lines {
+        std::vector<float> startX, startY, endX, endY, dirX, dirY, radius;
+    } m_lines;
+    // triangles are rare and their distance function is branchy, they are checked one by one
+    std::vector<StaticObstacles::Triangle> m_triangles;
+};
+
+#endif // STATICOBSTACLEARRAYS_H
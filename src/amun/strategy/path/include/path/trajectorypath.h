@@ -32,13 +32,33 @@
 #include <vector>
 
 class ProtobufFileSaver;
+class QThreadPool;
 
 class TrajectoryPath : public AbstractPath
 {
+public:
+    struct BatchInput {
+        // trajectory of another input of the same batch, added as friendly robot obstacle
+        struct AvoidedTrajectory {
+            int input; // must be smaller than the index of the avoiding input
+            int prio;
+            float radius;
+        };
+
+        TrajectoryPath *path;
+        Vector s0, v0, s1, v1;
+        float maxSpeed;
+        float acceleration;
+        std::vector<AvoidedTrajectory> avoid;
+    };
+
 public:
     TrajectoryPath(uint32_t rng_seed, ProtobufFileSaver *inputSaver, pathfinding::InputSourceType captureType);
     void reset() override;
     std::vector<TrajectoryPoint> calculateTrajectory(Vector s0, Vector v0, Vector s1, Vector v1, float maxSpeed, float acceleration);
+    // plans the inputs concurrently, an input only waits for the inputs whose trajectories it avoids
+    // every path may only be used once per batch and its world must not reference other trajectories of the batch
+    static std::vector<std::vector<TrajectoryPoint>> calculateTrajectories(const std::vector<BatchInput> &inputs, QThreadPool *pool = nullptr);
     // is guaranteed to be equally spaced in time
     std::vector<TrajectoryPoint> *getCurrentTrajectory() { return &m_currentTrajectory; }
     int maxIntersectingObstaclePrio() const { return m_escapeObstacleSampler.getMaxIntersectingObstaclePrio(); }
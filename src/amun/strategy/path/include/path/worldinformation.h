@@ -24,8 +24,11 @@
 #include "core/vector.h"
 #include "obstacles.h"
 #include "alphatimetrajectory.h"
+#include "obstaclegrid.h"
+#include "staticobstaclearrays.h"
 #include "protobuf/pathfinding.pb.h"
 #include <QVector>
+#include <memory>
 
 class WorldInformation
 {
@@ -42,19 +45,32 @@ public:
     int robotId() const { return m_robotId; }
 
     // world obstacles
+    // removes all obstacles and obstacle sets
     void clearObstacles();
+    // removes the own static obstacles, this invalidates their handles
+    void clearStaticObstacles();
+    void clearMovingObstacles();
     // only valid after a call to collectObstacles, may become invalid after the calling function returns!
     QVector<const StaticObstacles::Obstacle*> &obstacles() const { return m_obstacles; }
-    void addToAllStaticObstacleRadius(float additionalRadius);
     const std::vector<MovingObstacles::MovingObstacle*> &movingObstacles() const { return m_movingObstacles; }
 
     // static obstacles
-    void addCircle(float x, float y, float radius, const char *name, int prio);
+    // circles and rects return a handle that stays valid until the obstacles are cleared
+    int addCircle(float x, float y, float radius, const char *name, int prio);
     void addLine(float x1, float y1, float x2, float y2, float width, const char *name, int prio);
-    void addRect(float x1, float y1, float x2, float y2, const char *name, int prio, float radius);
+    int addRect(float x1, float y1, float x2, float y2, const char *name, int prio, float radius);
     void addTriangle(float x1, float y1, float x2, float y2, float x3, float y3, float lineWidth, const char *name, int prio);
-
-    void collectObstacles() const;
+    // move or resize an obstacle in place, returns false for invalid handles
+    bool updateCircle(int handle, float x, float y, float radius);
+    bool updateRect(int handle, float x1, float y1, float x2, float y2, float radius);
+    // references the static obstacles of another world, e.g. a set of field obstacles shared by all robots
+    // changes to the set are seen by the next collectObstacles, adding a set twice has no effect
+    void addObstacleSet(const std::shared_ptr<const WorldInformation> &set);
+    void removeObstacleSet(const std::shared_ptr<const WorldInformation> &set);
+
+    // gathers the own obstacles and those of the obstacle sets, all enlarged by additionalRadius
+    // the stored obstacles are not changed, also builds the grid and the obstacle arrays used by the trajectory and distance checks
+    void collectObstacles(float additionalRadius = 0) const;
     bool pointInPlayfield(const Vector &point, float radius) const;
 
     // moving obstacles
@@ -77,6 +93,10 @@ public:
         }
         return false;
     }
+    // checks all static obstacles, collectObstacles must have been called before
+    bool isInStaticObstacle(Vector point) const {
+        return !pointInPlayfield(point, m_radius) || m_obstacleArrays.isInObstacle(point);
+    }
 
     bool isInMovingObstacle(const std::vector<MovingObstacles::MovingObstacle *> &obstacles, Vector point, float time) const;
     bool isTrajectoryInObstacle(const SpeedProfile &profile, float timeOffset, Vector startPos) const;
@@ -94,11 +114,19 @@ public:
 
 private:
     mutable QVector<const StaticObstacles::Obstacle*> m_obstacles;
+    // the obstacles of the last collectObstacles call, m_obstacles points into these
+    mutable std::vector<StaticObstacles::Circle> m_collectedCircles;
+    mutable std::vector<StaticObstacles::Rect> m_collectedRects;
+    mutable std::vector<StaticObstacles::Triangle> m_collectedTriangles;
+    mutable std::vector<StaticObstacles::Line> m_collectedLines;
+    mutable ObstacleGrid m_obstacleGrid;
+    mutable StaticObstacleArrays m_obstacleArrays;
 
     std::vector<StaticObstacles::Circle> m_circleObstacles;
     std::vector<StaticObstacles::Rect> m_rectObstacles;
     std::vector<StaticObstacles::Triangle> m_triangleObstacles;
     std::vector<StaticObstacles::Line> m_lineObstacles;
+    std::vector<std::shared_ptr<const WorldInformation>> m_obstacleSets;
 
     std::vector<MovingObstacles::MovingCircle> m_movingCircles;
     std::vector<MovingObstacles::MovingLine> m_movingLines;
@@ -0,0 +1,91 @@
+/***************************************************************************
+ *   Copyright 2021                                                        *
+ *   Robotics Erlangen e.V.                                                *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "obstaclegrid.h"
+#include <algorithm>
+#include <cmath>
+
+void ObstacleGrid::build(const QVector<const StaticObstacles::Obstacle*> &obstacles)
+{
+    m_obstacles.assign(obstacles.begin(), obstacles.end());
+    m_boxes.clear();
+    m_cellStart.clear();
+    m_cellObstacles.clear();
+    m_largeObstacles.clear();
+    m_firstColumn.clear();
+    m_firstRow.clear();
+    m_width = 0;
+    m_height = 0;
+    if (m_obstacles.empty()) {
+        return;
+    }
+
+    m_boxes.reserve(m_obstacles.size());
+    for (const StaticObstacles::Obstacle *o : m_obstacles) {
+        m_boxes.push_back(o->boundingBox());
+    }
+    m_area = m_boxes[0];
+    for (const BoundingBox &box : m_boxes) {
+        m_area.mergePoint(Vector(box.left, box.bottom));
+        m_area.mergePoint(Vector(box.right, box.top));
+    }
+
+    const float extent = std::max(m_area.right - m_area.left, m_area.top - m_area.bottom);
+    m_cellSize = std::max(MIN_CELL_SIZE, extent / MAX_CELLS_PER_AXIS);
+    m_width = std::min(MAX_CELLS_PER_AXIS, int((m_area.right - m_area.left) / m_cellSize) + 1);
+    m_height = std::min(MAX_CELLS_PER_AXIS, int((m_area.top - m_area.bottom) / m_cellSize) + 1);
+
+    // count the obstacles per cell first, then fill them in
+    m_cellStart.assign(m_width * m_height + 1, 0);
+    m_firstColumn.resize(m_boxes.size());
+    m_firstRow.resize(m_boxes.size());
+    for (std::size_t i = 0;i<m_boxes.size();i++) {
+        int x0, y0, x1, y1;
+        cellRange(m_boxes[i], x0, y0, x1, y1);
+        m_firstColumn[i] = x0;
+        m_firstRow[i] = y0;
+        if ((x1 - x0 + 1) * (y1 - y0 + 1) > MAX_CELLS_PER_OBSTACLE) {
+            m_largeObstacles.push_back(int(i));
+            continue;
+        }
+        for (int y = y0;y<=y1;y++) {
+            for (int x = x0;x<=x1;x++) {
+                m_cellStart[y * m_width + x + 1]++;
+            }
+        }
+    }
+    for (std::size_t c = 1;c<m_cellStart.size();c++) {
+        m_cellStart[c] += m_cellStart[c - 1];
+    }
+    m_cellObstacles.resize(m_cellStart.back());
+    std::vector<int> fill(m_cellStart.begin(), m_cellStart.end() - 1);
+    for (std::size_t i = 0;i<m_boxes.size();i++) {
+        int x0, y0, x1, y1;
+        cellRange(m_boxes[i], x0, y0, x1, y1);
+        if ((x1 - x0 + 1) * (y1 - y0 + 1) > MAX_CELLS_PER_OBSTACLE) {
+            continue;
+        }
+        for (int y = y0;y<=y1;y++) {
+            for (int x = x0;x<=x1;x++) {
+                m_cellObstacles[fill[y * m_width + x]++] = int(i);
+            }
+        }
+    }
+}
@@ -0,0 +1,129 @@
+/***************************************************************************
+ *   Copyright 2021                                                        *
+ *   Robotics Erlangen e.V.                                                *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "staticobstaclearrays.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+void StaticObstacleArrays::build(const std::vector<StaticObstacles::Circle> &circles, const std::vector<StaticObstacles::Rect> &rects,
+                                 const std::vector<StaticObstacles::Triangle> &triangles, const std::vector<StaticObstacles::Line> &lines)
+{
+    m_circles = Circles();
+    for (const StaticObstacles::Circle &c : circles) {
+        m_circles.x.push_back(c.center.x);
+        m_circles.y.push_back(c.center.y);
+        m_circles.radius.push_back(c.radius);
+    }
+
+    m_rects = Rects();
+    for (const StaticObstacles::Rect &r : rects) {
+        m_rects.left.push_back(r.bottomLeft.x);
+        m_rects.bottom.push_back(r.bottomLeft.y);
+        m_rects.right.push_back(r.topRight.x);
+        m_rects.top.push_back(r.topRight.y);
+        m_rects.radius.push_back(r.radius);
+    }
+
+    m_lines = Lines();
+    for (const StaticObstacles::Line &l : lines) {
+        const std::vector<Vector> corners = l.corners();
+        const LineSegment segment(corners[0], corners[1]);
+        m_lines.startX.push_back(segment.start().x);
+        m_lines.startY.push_back(segment.start().y);
+        m_lines.endX.push_back(segment.end().x);
+        m_lines.endY.push_back(segment.end().y);
+        m_lines.dirX.push_back(segment.dir().x);
+        m_lines.dirY.push_back(segment.dir().y);
+        m_lines.radius.push_back(l.radius);
+    }
+
+    m_triangles = triangles;
+}
+
+float StaticObstacleArrays::minCircleDistance(Vector point) const
+{
+    float result = std::numeric_limits<float>::max();
+    const std::size_t count = m_circles.x.size();
+    for (std::size_t i = 0;i<count;i++) {
+        const float dx = point.x - m_circles.x[i];
+        const float dy = point.y - m_circles.y[i];
+        result = std::min(result, std::sqrt(dx * dx + dy * dy) - m_circles.radius[i]);
+    }
+    return result;
+}
+
+float StaticObstacleArrays::minRectDistance(Vector point) const
+{
+    // see StaticObstacles::Rect::distance, the cases are merged into one expression
+    float result = std::numeric_limits<float>::max();
+    const std::size_t count = m_rects.left.size();
+    for (std::size_t i = 0;i<count;i++) {
+        const float distX = std::max(m_rects.left[i] - point.x, point.x - m_rects.right[i]);
+        const float distY = std::max(m_rects.bottom[i] - point.y, point.y - m_rects.top[i]);
+        const float outsideX = std::max(distX, 0.0f);
+        const float outsideY = std::max(distY, 0.0f);
+        const float outside = std::sqrt(outsideX * outsideX + outsideY * outsideY);
+        const float inside = std::min(std::max(distX, distY), 0.0f);
+        result = std::min(result, outside + inside - m_rects.radius[i]);
+    }
+    return result;
+}
+
+float StaticObstacleArrays::minLineDistance(Vector point) const
+{
+    // see LineSegment::distance, all cases are computed and the matching one is selected
+    float result = std::numeric_limits<float>::max();
+    const std::size_t count = m_lines.startX.size();
+    for (std::size_t i = 0;i<count;i++) {
+        const float startDx = point.x - m_lines.startX[i];
+        const float startDy = point.y - m_lines.startY[i];
+        const float endDx = point.x - m_lines.endX[i];
+        const float endDy = point.y - m_lines.endY[i];
+        const float startDot = startDx * m_lines.dirX[i] + startDy * m_lines.dirY[i];
+        const float endDot = endDx * m_lines.dirX[i] + endDy * m_lines.dirY[i];
+        const float startDistSq = startDx * startDx + startDy * startDy;
+        const float endDistSq = endDx * endDx + endDy * endDy;
+        // at most one of the end points is the closest point, thus a single square root is enough
+        const float endPointDist = std::sqrt(startDot < 0.0f ? startDistSq : endDistSq);
+        // the normal of the segment is (-dir.y, dir.x)
+        const float sideDist = std::abs(endDy * m_lines.dirX[i] - endDx * m_lines.dirY[i]);
+        // same as startDot < 0 || endDot > 0, but the compiler can't skip the end point computations
+        // for startDot < 0 and has no conditional loads that prevent the vectorization
+        const bool atEndPoint = std::min(startDot, -endDot) < 0.0f;
+        const float dist = atEndPoint ? endPointDist : sideDist;
+        result = std::min(result, dist - m_lines.radius[i]);
+    }
+    return result;
+}
+
+float StaticObstacleArrays::minDistance(Vector point) const
+{
+    float result = std::min(minCircleDistance(point), std::min(minRectDistance(point), minLineDistance(point)));
+    for (const StaticObstacles::Triangle &t : m_triangles) {
+        result = std::min(result, t.StaticObstacles::Triangle::distance(point));
+    }
+    return result;
+}
+
+bool StaticObstacleArrays::isInObstacle(Vector point) const
+{
+    return minDistance(point) < 0;
+}
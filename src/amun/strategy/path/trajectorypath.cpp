@@ -21,7 +21,9 @@
 #include "trajectorypath.h"
 #include "core/rng.h"
 #include "core/protobuffilesaver.h"
+#include "core/parallelfor.h"
 #include <QDebug>
+#include <algorithm>
 
 
 TrajectoryPath::TrajectoryPath(uint32_t rng_seed, ProtobufFileSaver *inputSaver, pathfinding::InputSourceType captureType) :
@@ -61,6 +63,51 @@ std::vector<TrajectoryPoint> TrajectoryPath::calculateTrajectory(Vector s0, Vect
     return getResultPath(findPath(input), input);
 }
 
+std::vector<std::vector<TrajectoryPoint>> TrajectoryPath::calculateTrajectories(const std::vector<BatchInput> &inputs, QThreadPool *pool)
+{
+    // an input is planned in the wave after the last one of the trajectories it avoids
+    std::vector<int> wave(inputs.size(), 0);
+    int waveCount = 0;
+    for (std::size_t i = 0;i<inputs.size();i++) {
+        for (const auto &avoid : inputs[i].avoid) {
+            wave[i] = std::max(wave[i], wave[avoid.input] + 1);
+        }
+        waveCount = std::max(waveCount, wave[i] + 1);
+    }
+
+    std::vector<std::vector<TrajectoryPoint>> results(inputs.size());
+    std::vector<std::size_t> current;
+    for (int w = 0;w<waveCount;w++) {
+        current.clear();
+        for (std::size_t i = 0;i<inputs.size();i++) {
+            if (wave[i] != w) {
+                continue;
+            }
+            for (const auto &avoid : inputs[i].avoid) {
+                inputs[i].path->world().addFriendlyRobotTrajectoryObstacle(inputs[avoid.input].path->getCurrentTrajectory(),
+                                                                           avoid.prio, avoid.radius);
+            }
+            current.push_back(i);
+        }
+
+        auto plan = [&inputs, &results, &current](int index) {
+            const BatchInput &input = inputs[current[index]];
+            results[current[index]] = input.path->calculateTrajectory(input.s0, input.v0, input.s1, input.v1,
+                                                                      input.maxSpeed, input.acceleration);
+        };
+#if defined(ACTIVE_PATHFINDING_PARAMETER_OPTIMIZATION) || defined(PATHFINDING_DEBUG)
+        // the parameter optimization and the debug output are single threaded only
+        Q_UNUSED(pool);
+        for (std::size_t i = 0;i<current.size();i++) {
+            plan(int(i));
+        }
+#else
+        parallelFor(int(current.size()), plan, pool);
+#endif
+    }
+    return results;
+}
+
 static void setVector(Vector v, pathfinding::Vector *out)
 {
     out->set_x(v.x);
@@ -114,12 +161,9 @@ bool TrajectoryPath::testSampler(const TrajectoryInput &input, pathfinding::Inpu
 
 std::vector<TrajectorySampler::TrajectoryGenerationInfo> TrajectoryPath::findPath(TrajectoryInput input)
 {
-    const auto &obstacles = m_world.obstacles();
-
     m_escapeObstacleSampler.resetMaxIntersectingObstaclePrio();
 
-    m_world.addToAllStaticObstacleRadius(m_world.radius());
-    m_world.collectObstacles();
+    m_world.collectObstacles(m_world.radius());
     m_world.collectMovingObstacles();
 
     if (m_captureType == pathfinding::AllSamplers && m_inputSaver != nullptr) {
@@ -128,7 +172,7 @@ std::vector<TrajectorySampler::TrajectoryGenerationInfo> TrajectoryPath::findPat
 
     // check if start point is in obstacle
     std::vector<TrajectorySampler::TrajectoryGenerationInfo> escapeObstacle;
-    if (m_world.isInStaticObstacle(obstacles, input.s0) || m_world.isInMovingObstacle(m_world.movingObstacles(), input.s0, 0)) {
+    if (m_world.isInStaticObstacle(input.s0) || m_world.isInMovingObstacle(m_world.movingObstacles(), input.s0, 0)) {
         if (!testSampler(input, pathfinding::EscapeObstacleSampler)) {
             // no fallback for now
             return {};
@@ -149,8 +193,8 @@ std::vector<TrajectorySampler::TrajectoryGenerationInfo> TrajectoryPath::findPat
     }
 
     // check if end point is in obstacle
-    if (m_world.isInStaticObstacle(obstacles, input.s1)) {
-        for (const StaticObstacles::Obstacle *o : obstacles) {
+    if (m_world.isInStaticObstacle(input.s1)) {
+        for (const StaticObstacles::Obstacle *o : m_world.obstacles()) {
             float dist = o->distance(input.s1);
             if (dist > -0.2 && dist < 0) {
                 input.s1 = o->projectOut(input.s1, 0.03f);
@@ -159,7 +203,7 @@ std::vector<TrajectorySampler::TrajectoryGenerationInfo> TrajectoryPath::findPat
         input.distance = input.s1 - input.s0;
         // test again, might have been moved into another obstacle
         // TODO: check moving obstacles with minimum
-        if (m_world.isInStaticObstacle(obstacles, input.s1)) {
+        if (m_world.isInStaticObstacle(input.s1)) {
             if (testSampler(input, pathfinding::EndInObstacleSampler)) {
                 return concat(escapeObstacle, m_endInObstacleSampler.getResult());
             }
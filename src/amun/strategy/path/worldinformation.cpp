@@ -21,6 +21,7 @@
 #include "worldinformation.h"
 
 #include <QDebug>
+#include <algorithm>
 
 void WorldInformation::setRadius(float r)
 {
@@ -36,28 +37,31 @@ void WorldInformation::setBoundary(float x1, float y1, float x2, float y2)
 }
 
 void WorldInformation::clearObstacles()
+{
+    clearStaticObstacles();
+    clearMovingObstacles();
+    m_obstacleSets.clear();
+}
+
+void WorldInformation::clearStaticObstacles()
 {
     m_circleObstacles.clear();
     m_rectObstacles.clear();
     m_triangleObstacles.clear();
     m_lineObstacles.clear();
+}
 
+void WorldInformation::clearMovingObstacles()
+{
     m_movingCircles.clear();
     m_movingLines.clear();
     m_friendlyRobotObstacles.clear();
 }
 
-void WorldInformation::addToAllStaticObstacleRadius(float additionalRadius)
-{
-    for (StaticObstacles::Circle &c: m_circleObstacles) { c.radius += additionalRadius; }
-    for (StaticObstacles::Rect &r: m_rectObstacles) { r.radius += additionalRadius; }
-    for (StaticObstacles::Triangle &t: m_triangleObstacles) { t.radius += additionalRadius; }
-    for (StaticObstacles::Line &l: m_lineObstacles) { l.radius += additionalRadius; }
-}
-
-void WorldInformation::addCircle(float x, float y, float radius, const char* name, int prio)
+int WorldInformation::addCircle(float x, float y, float radius, const char* name, int prio)
 {
     m_circleObstacles.emplace_back(name, prio, radius, Vector(x, y));
+    return int(m_circleObstacles.size()) - 1;
 }
 
 void WorldInformation::addLine(float x1, float y1, float x2, float y2, float width, const char* name, int prio)
@@ -65,10 +69,11 @@ void WorldInformation::addLine(float x1, float y1, float x2, float y2, float wid
     m_lineObstacles.emplace_back(name, prio, width, Vector(x1, y1), Vector(x2, y2));
 }
 
-void WorldInformation::addRect(float x1, float y1, float x2, float y2, const char* name, int prio, float radius)
+int WorldInformation::addRect(float x1, float y1, float x2, float y2, const char* name, int prio, float radius)
 {
     StaticObstacles::Rect r(name, prio, x1, y1, x2, y2, radius);
     m_rectObstacles.push_back(r);
+    return int(m_rectObstacles.size()) - 1;
 }
 
 void WorldInformation::addTriangle(float x1, float y1, float x2, float y2, float x3, float y3, float lineWidth, const char *name, int prio)
@@ -76,13 +81,80 @@ void WorldInformation::addTriangle(float x1, float y1, float x2, float y2, float
     m_triangleObstacles.emplace_back(name, prio, lineWidth, Vector(x1, y1), Vector(x2, y2), Vector(x3, y3));
 }
 
-void WorldInformation::collectObstacles() const
+bool WorldInformation::updateCircle(int handle, float x, float y, float radius)
+{
+    if (handle < 0 || handle >= int(m_circleObstacles.size())) {
+        return false;
+    }
+    StaticObstacles::Circle &circle = m_circleObstacles[handle];
+    StaticObstacles::Circle updated(nullptr, circle.prio, radius, Vector(x, y));
+    updated.name = circle.name;
+    circle = updated;
+    return true;
+}
+
+bool WorldInformation::updateRect(int handle, float x1, float y1, float x2, float y2, float radius)
+{
+    if (handle < 0 || handle >= int(m_rectObstacles.size())) {
+        return false;
+    }
+    StaticObstacles::Rect &rect = m_rectObstacles[handle];
+    StaticObstacles::Rect updated(nullptr, rect.prio, x1, y1, x2, y2, radius);
+    updated.name = rect.name;
+    rect = updated;
+    return true;
+}
+
+void WorldInformation::addObstacleSet(const std::shared_ptr<const WorldInformation> &set)
+{
+    if (set.get() == this || std::find(m_obstacleSets.begin(), m_obstacleSets.end(), set) != m_obstacleSets.end()) {
+        return;
+    }
+    m_obstacleSets.push_back(set);
+}
+
+void WorldInformation::removeObstacleSet(const std::shared_ptr<const WorldInformation> &set)
+{
+    m_obstacleSets.erase(std::remove(m_obstacleSets.begin(), m_obstacleSets.end(), set), m_obstacleSets.end());
+}
+
+template<typename T>
+static void collectWithRadius(std::vector<T> &result, const std::vector<T> &obstacles, float additionalRadius)
 {
+    const std::size_t start = result.size();
+    result.insert(result.end(), obstacles.begin(), obstacles.end());
+    if (additionalRadius != 0) {
+        for (std::size_t i = start;i<result.size();i++) {
+            result[i].radius += additionalRadius;
+        }
+    }
+}
+
+void WorldInformation::collectObstacles(float additionalRadius) const
+{
+    m_collectedCircles.clear();
+    m_collectedRects.clear();
+    m_collectedTriangles.clear();
+    m_collectedLines.clear();
+    collectWithRadius(m_collectedCircles, m_circleObstacles, additionalRadius);
+    collectWithRadius(m_collectedRects, m_rectObstacles, additionalRadius);
+    collectWithRadius(m_collectedTriangles, m_triangleObstacles, additionalRadius);
+    collectWithRadius(m_collectedLines, m_lineObstacles, additionalRadius);
+    // only the own obstacles of a set are used, not the ones of the sets it references
+    for (const auto &set : m_obstacleSets) {
+        collectWithRadius(m_collectedCircles, set->m_circleObstacles, additionalRadius);
+        collectWithRadius(m_collectedRects, set->m_rectObstacles, additionalRadius);
+        collectWithRadius(m_collectedTriangles, set->m_triangleObstacles, additionalRadius);
+        collectWithRadius(m_collectedLines, set->m_lineObstacles, additionalRadius);
+    }
+
     m_obstacles.clear();
-    for (const StaticObstacles::Circle &c: m_circleObstacles) { m_obstacles.append(&c); }
-    for (const StaticObstacles::Rect &r: m_rectObstacles) { m_obstacles.append(&r); }
-    for (const StaticObstacles::Triangle &t: m_triangleObstacles) { m_obstacles.append(&t); }
-    for (const StaticObstacles::Line &l: m_lineObstacles) { m_obstacles.append(&l); }
+    for (const StaticObstacles::Circle &c: m_collectedCircles) { m_obstacles.append(&c); }
+    for (const StaticObstacles::Rect &r: m_collectedRects) { m_obstacles.append(&r); }
+    for (const StaticObstacles::Triangle &t: m_collectedTriangles) { m_obstacles.append(&t); }
+    for (const StaticObstacles::Line &l: m_collectedLines) { m_obstacles.append(&l); }
+    m_obstacleGrid.build(m_obstacles);
+    m_obstacleArrays.build(m_collectedCircles, m_collectedRects, m_collectedTriangles, m_collectedLines);
 }
 
 void WorldInformation::collectMovingObstacles()
@@ -159,13 +231,6 @@ bool WorldInformation::isInMovingObstacle(const std::vector<MovingObstacles::Mov
 bool WorldInformation::isTrajectoryInObstacle(const SpeedProfile &profile, float timeOffset, Vector startPos) const
 {
     BoundingBox trajectoryBoundingBox = profile.calculateBoundingBox(startPos);
-    std::vector<const StaticObstacles::Obstacle*> intersectingStaticObstacles;
-    intersectingStaticObstacles.reserve(m_obstacles.size());
-    for (const StaticObstacles::Obstacle *o : m_obstacles) {
-        if (o->boundingBox().intersects(trajectoryBoundingBox)) {
-            intersectingStaticObstacles.push_back(o);
-        }
-    }
     std::vector<MovingObstacles::MovingObstacle*> intersectingMovingObstacles;
     intersectingMovingObstacles.reserve(m_movingObstacles.size());
     for (MovingObstacles::MovingObstacle *o : m_movingObstacles) {
@@ -181,14 +246,25 @@ bool WorldInformation::isTrajectoryInObstacle(const SpeedProfile &profile, float
 
     for (int i = 0;i<DIVISIONS;i++) {
         float time = totalTime * i / float(DIVISIONS-1);
-        if (isInStaticObstacle(intersectingStaticObstacles, trajectoryPoints[i])) {
+        if (!pointInPlayfield(trajectoryPoints[i], m_radius)) {
             return true;
         }
         if (isInMovingObstacle(intersectingMovingObstacles, trajectoryPoints[i], time + timeOffset)) {
             return true;
         }
     }
-    return false;
+
+    bool inObstacle = false;
+    m_obstacleGrid.visit(trajectoryBoundingBox, [&](const StaticObstacles::Obstacle *obstacle) {
+        for (const Vector &point : trajectoryPoints) {
+            if (obstacle->distance(point) < 0) {
+                inObstacle = true;
+                return false;
+            }
+        }
+        return true;
+    });
+    return inObstacle;
 }
 
 float WorldInformation::minObstacleDistancePoint(Vector pos, float time, bool checkStatic, bool checkDynamic) const
@@ -196,12 +272,9 @@ float WorldInformation::minObstacleDistancePoint(Vector pos, float time, bool ch
     float minDistance = std::numeric_limits<float>::max();
     // static obstacles
     if (checkStatic) {
-        for (const auto obstacle : m_obstacles) {
-            float d = obstacle->distance(pos);
-            if (d <= 0) {
-                return d;
-            }
-            minDistance = std::min(minDistance, d);
+        minDistance = m_obstacleArrays.minDistance(pos);
+        if (minDistance <= 0) {
+            return minDistance;
         }
     }
     // moving obstacles
@@ -258,17 +331,21 @@ std::pair<ZonedIntersection, ZonedIntersection> WorldInformation::minObstacleDis
 
     trajectoryBox.addExtraRadius(safetyMargin);
 
-    for (auto obstacle : m_obstacles) {
-        if (obstacle->boundingBox().intersects(trajectoryBox)) {
-            for (std::size_t i = 0;i<DIVISIONS;i++) {
-                ZonedIntersection intersection = obstacle->zonedDistance(trajectoryPoints[i], safetyMargin);
-                if (intersection == ZonedIntersection::IN_OBSTACLE) {
-                    return {intersection, intersection};
-                } else if (intersection == ZonedIntersection::NEAR_OBSTACLE) {
-                    totalIntersection = intersection;
-                }
+    bool inObstacle = false;
+    m_obstacleGrid.visit(trajectoryBox, [&](const StaticObstacles::Obstacle *obstacle) {
+        for (const Vector &point : trajectoryPoints) {
+            ZonedIntersection intersection = obstacle->zonedDistance(point, safetyMargin);
+            if (intersection == ZonedIntersection::IN_OBSTACLE) {
+                inObstacle = true;
+                return false;
+            } else if (intersection == ZonedIntersection::NEAR_OBSTACLE) {
+                totalIntersection = intersection;
             }
         }
+        return true;
+    });
+    if (inObstacle) {
+        return {ZonedIntersection::IN_OBSTACLE, ZonedIntersection::IN_OBSTACLE};
     }
 
     for (auto obstacle : m_movingObstacles) {
@@ -180,7 +180,9 @@ void Strategy::handleStatus(const Status &status)
             // Instead of processing each tracking packet, only the most recent one
             // will be used.
             // guarantees that the tracking packet used by the strategy is at most 10 ms old
-            m_idleTimer->start();
+            if (!m_manualTrigger) {
+                m_idleTimer->start();
+            }
         }
     } else {
         if ((status->has_blue_running() && status->blue_running() && m_type == StrategyType::BLUE)
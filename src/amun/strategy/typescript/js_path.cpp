@@ -22,6 +22,7 @@
 
 #include <QList>
 #include <v8.h>
+#include <algorithm>
 #include "strategy/script/scriptstate.h"
 #include "path/path.h"
 #include "path/trajectorypath.h"
@@ -49,10 +50,11 @@ using namespace v8helper;
 class QTPath: public QObject {
     Q_OBJECT
 public:
-    QTPath(Path *p, TrajectoryPath *tp, Typescript *t):
+    QTPath(Path *p, TrajectoryPath *tp, Typescript *t, WorldInformation *obstacleSet = nullptr):
         QObject(t),
         p(p),
         tp(tp),
+        w(obstacleSet),
         t(t)
     {
         if (tp != nullptr) {
@@ -63,11 +65,16 @@ public:
     Path *path() const { return p.get(); }
     AbstractPath *abstractPath() const { return p ? static_cast<AbstractPath*>(p.get()) : tp.get(); }
     TrajectoryPath *trajectoryPath() const { return tp.get(); }
+    // shared with the worlds of the paths that reference the set
+    const std::shared_ptr<WorldInformation> &obstacleSet() const { return w; }
+    // obstacle sets only have a world without a path
+    WorldInformation &world() const { return w ? *w : abstractPath()->world(); }
     Typescript *typescript() const { return t; }
 
 private:
     std::unique_ptr<Path> p;
     std::unique_ptr<TrajectoryPath> tp;
+    std::shared_ptr<WorldInformation> w;
     Typescript *t;
 };
 
@@ -99,10 +106,26 @@ GENERATE_FUNCTIONS(pathReset);
 
 static void pathClearObstacles(QTPath *wrapper, const FunctionCallbackInfo<Value>&, int)
 {
-    wrapper->abstractPath()->clearObstacles();
+    if (wrapper->obstacleSet() != nullptr) {
+        wrapper->obstacleSet()->clearObstacles();
+    } else {
+        wrapper->abstractPath()->clearObstacles();
+    }
 }
 GENERATE_FUNCTIONS(pathClearObstacles);
 
+static void pathClearStaticObstacles(const FunctionCallbackInfo<Value>& args)
+{
+    QTPath *wrapper = static_cast<QTPath*>(Local<External>::Cast(args.Data())->Value());
+    wrapper->world().clearStaticObstacles();
+}
+
+static void trajectoryClearMovingObstacles(const FunctionCallbackInfo<Value>& args)
+{
+    QTPath *wrapper = static_cast<QTPath*>(Local<External>::Cast(args.Data())->Value());
+    wrapper->trajectoryPath()->world().clearMovingObstacles();
+}
+
 static void pathSeedRandom(const FunctionCallbackInfo<Value>& args)
 {
     Isolate * isolate = args.GetIsolate();
@@ -127,7 +150,7 @@ static void pathSetBoundary(QTPath *wrapper, const FunctionCallbackInfo<Value>&
             !verifyNumber(isolate, args[2 + offset], x2) || !verifyNumber(isolate, args[3 + offset], y2)) {
         return;
     }
-    wrapper->abstractPath()->world().setBoundary(x1, y1, x2, y2);
+    wrapper->world().setBoundary(x1, y1, x2, y2);
 }
 GENERATE_FUNCTIONS(pathSetBoundary);
 
@@ -138,7 +161,7 @@ static void pathSetRadius(QTPath *wrapper, const FunctionCallbackInfo<Value>& ar
     if (!verifyNumber(isolate, args[offset], r)) {
         return;
     }
-    wrapper->abstractPath()->world().setRadius(r);
+    wrapper->world().setRadius(r);
 }
 GENERATE_FUNCTIONS(pathSetRadius);
 
@@ -151,7 +174,8 @@ static void pathAddCircle(QTPath *wrapper, const FunctionCallbackInfo<Value>& ar
             !verifyNumber(isolate, args[2 + offset], r) || !verifyNumber(isolate, args[4 + offset], prio)) {
         return;
     }
-    wrapper->abstractPath()->world().addCircle(x, y, r, nullptr, int(prio));
+    const int handle = wrapper->world().addCircle(x, y, r, nullptr, int(prio));
+    args.GetReturnValue().Set(Number::New(isolate, handle));
 }
 GENERATE_FUNCTIONS(pathAddCircle);
 
@@ -170,7 +194,7 @@ static void pathAddLine(QTPath *wrapper, const FunctionCallbackInfo<Value>& args
         isolate->ThrowException(Exception::Error(v8string(isolate, "line must have non zero length")));
         return;
     }
-    wrapper->abstractPath()->world().addLine(x1, y1, x2, y2, width, nullptr, int(prio));
+    wrapper->world().addLine(x1, y1, x2, y2, width, nullptr, int(prio));
 }
 GENERATE_FUNCTIONS(pathAddLine);
 
@@ -210,7 +234,8 @@ static void pathAddRect(QTPath *wrapper, const FunctionCallbackInfo<Value>& args
         radius = args[6 + offset]->ToNumber(isolate->GetCurrentContext()).ToLocalChecked()->Value();
     }
 
-    wrapper->abstractPath()->world().addRect(x1, y1, x2, y2, nullptr, int(prio), radius);
+    const int handle = wrapper->world().addRect(x1, y1, x2, y2, nullptr, int(prio), radius);
+    args.GetReturnValue().Set(Number::New(isolate, handle));
 }
 GENERATE_FUNCTIONS(pathAddRect);
 
@@ -225,10 +250,76 @@ static void pathAddTriangle(QTPath *wrapper, const FunctionCallbackInfo<Value>&
         return;
     }
 
-    wrapper->abstractPath()->world().addTriangle(x1, y1, x2, y2, x3, y3, lineWidth, nullptr, int(prio));
+    wrapper->world().addTriangle(x1, y1, x2, y2, x3, y3, lineWidth, nullptr, int(prio));
 }
 GENERATE_FUNCTIONS(pathAddTriangle);
 
+static void pathUpdateCircle(const FunctionCallbackInfo<Value>& args)
+{
+    Isolate *isolate = args.GetIsolate();
+    QTPath *wrapper = static_cast<QTPath*>(Local<External>::Cast(args.Data())->Value());
+    float handle, x, y, r;
+    if (!verifyNumber(isolate, args[0], handle) || !verifyNumber(isolate, args[1], x) ||
+            !verifyNumber(isolate, args[2], y) || !verifyNumber(isolate, args[3], r)) {
+        return;
+    }
+    if (!wrapper->world().updateCircle(int(handle), x, y, r)) {
+        isolate->ThrowException(Exception::Error(v8string(isolate, "Invalid obstacle handle")));
+    }
+}
+
+static void pathUpdateRect(const FunctionCallbackInfo<Value>& args)
+{
+    Isolate *isolate = args.GetIsolate();
+    QTPath *wrapper = static_cast<QTPath*>(Local<External>::Cast(args.Data())->Value());
+    float handle, x1, y1, x2, y2, radius;
+    if (!verifyNumber(isolate, args[0], handle) || !verifyNumber(isolate, args[1], x1) ||
+            !verifyNumber(isolate, args[2], y1) || !verifyNumber(isolate, args[3], x2) ||
+            !verifyNumber(isolate, args[4], y2) || !verifyNumber(isolate, args[5], radius)) {
+        return;
+    }
+    if (!wrapper->world().updateRect(int(handle), x1, y1, x2, y2, radius)) {
+        isolate->ThrowException(Exception::Error(v8string(isolate, "Invalid obstacle handle")));
+    }
+}
+
+static void obstacleSetGetHandle(const FunctionCallbackInfo<Value>& args)
+{
+    args.GetReturnValue().Set(args.Data());
+}
+
+static QTPath *getObstacleSet(const FunctionCallbackInfo<Value>& args, QTPath *wrapper)
+{
+    Isolate *isolate = args.GetIsolate();
+    // the handle could point to anything, only accept the obstacle sets of this strategy
+    QTPath *set = args[0]->IsExternal() ? static_cast<QTPath*>(Local<External>::Cast(args[0])->Value()) : nullptr;
+    const QList<QTPath*> paths = wrapper->typescript()->findChildren<QTPath*>(QString(), Qt::FindDirectChildrenOnly);
+    if (!paths.contains(set) || set->obstacleSet() == nullptr) {
+        isolate->ThrowException(Exception::Error(v8string(isolate, "Invalid obstacle set handle")));
+        return nullptr;
+    }
+    return set;
+}
+
+// references an obstacle set, later changes to the set are seen by the path until it is removed or the obstacles are cleared
+static void pathAddObstacleSet(const FunctionCallbackInfo<Value>& args)
+{
+    QTPath *wrapper = static_cast<QTPath*>(Local<External>::Cast(args.Data())->Value());
+    QTPath *set = getObstacleSet(args, wrapper);
+    if (set != nullptr) {
+        wrapper->world().addObstacleSet(set->obstacleSet());
+    }
+}
+
+static void pathRemoveObstacleSet(const FunctionCallbackInfo<Value>& args)
+{
+    QTPath *wrapper = static_cast<QTPath*>(Local<External>::Cast(args.Data())->Value());
+    QTPath *set = getObstacleSet(args, wrapper);
+    if (set != nullptr) {
+        wrapper->world().removeObstacleSet(set->obstacleSet());
+    }
+}
+
 static void pathTest(QTPath *wrapper, const FunctionCallbackInfo<Value>& args, int offset)
 {
     Local<Context> c = args.GetIsolate()->GetCurrentContext();
@@ -296,6 +387,27 @@ static void pathGet(QTPath *wrapper, const FunctionCallbackInfo<Value>& args, in
 }
 GENERATE_FUNCTIONS(pathGet);
 
+static Local<Array> trajectoryToJs(Isolate *isolate, const std::vector<TrajectoryPoint> &trajectory)
+{
+    unsigned int i = 0;
+    Local<Array> result = Array::New(isolate, trajectory.size());
+    Local<String> pxString = v8string(isolate, "px");
+    Local<String> pyString = v8string(isolate, "py");
+    Local<String> vxString = v8string(isolate, "vx");
+    Local<String> vyString = v8string(isolate, "vy");
+    Local<String> timeString = v8string(isolate, "time");
+    for (const auto &p : trajectory) {
+        Local<Object> pathPart = Object::New(isolate);
+        pathPart->Set(pxString, Number::New(isolate, double(p.pos.x)));
+        pathPart->Set(pyString, Number::New(isolate, double(p.pos.y)));
+        pathPart->Set(vxString, Number::New(isolate, double(p.speed.x)));
+        pathPart->Set(vyString, Number::New(isolate, double(p.speed.y)));
+        pathPart->Set(timeString, Number::New(isolate, double(p.time)));
+        result->Set(i++, pathPart);
+    }
+    return result;
+}
+
 static void trajectoryPathGet(const FunctionCallbackInfo<Value>& args)
 {
     QTPath *wrapper = static_cast<QTPath*>(Local<External>::Cast(args.Data())->Value());
@@ -321,28 +433,116 @@ static void trajectoryPathGet(const FunctionCallbackInfo<Value>& args)
     std::vector<TrajectoryPoint> trajectory = wrapper->trajectoryPath()->calculateTrajectory(Vector(startX, startY), Vector(startSpeedX, startSpeedY),
                                                      Vector(endX, endY), Vector(endSpeedX, endSpeedY), maxSpeed, acceleration);
 
-    // convert path to js object
-    unsigned int i = 0;
-    Local<Array> result = Array::New(isolate, trajectory.size());
-    Local<String> pxString = v8string(isolate, "px");
-    Local<String> pyString = v8string(isolate, "py");
-    Local<String> vxString = v8string(isolate, "vx");
-    Local<String> vyString = v8string(isolate, "vy");
-    Local<String> timeString = v8string(isolate, "time");
-    for (const auto &p : trajectory) {
-        Local<Object> pathPart = Object::New(isolate);
-        pathPart->Set(pxString, Number::New(isolate, double(p.pos.x)));
-        pathPart->Set(pyString, Number::New(isolate, double(p.pos.y)));
-        pathPart->Set(vxString, Number::New(isolate, double(p.speed.x)));
-        pathPart->Set(vyString, Number::New(isolate, double(p.speed.y)));
-        pathPart->Set(timeString, Number::New(isolate, double(p.time)));
-        result->Set(i++, pathPart);
-    }
+    Local<Array> result = trajectoryToJs(isolate, trajectory);
 
     wrapper->typescript()->addPathTime((Timer::systemTime() - t) / 1E9);
     args.GetReturnValue().Set(result);
 }
 
+static void trajectoryGetBatchHandle(const FunctionCallbackInfo<Value>& args)
+{
+    args.GetReturnValue().Set(args.Data());
+}
+
+// takes a list of requests [batchHandle, startX, startY, startSpeedX, startSpeedY, endX, endY, endSpeedX, endSpeedY,
+// maxSpeed, acceleration, avoid], where avoid is an optional list of [requestIndex, prio, radius] of earlier requests
+// returns the trajectories in the same order as the requests
+static void pathCalculateTrajectories(const FunctionCallbackInfo<Value>& args)
+{
+    Isolate *isolate = args.GetIsolate();
+    Typescript *ts = static_cast<QTPath*>(Local<External>::Cast(args.Data())->Value())->typescript();
+    const qint64 t = Timer::systemTime();
+
+    if (args.Length() != 1 || !args[0]->IsArray()) {
+        isolate->ThrowException(Exception::Error(v8string(isolate, "Invalid arguments")));
+        return;
+    }
+    Local<Array> requests = Local<Array>::Cast(args[0]);
+    const QList<QTPath*> paths = ts->findChildren<QTPath*>(QString(), Qt::FindDirectChildrenOnly);
+
+    std::vector<TrajectoryPath::BatchInput> inputs;
+    inputs.reserve(requests->Length());
+    for (unsigned int i = 0;i<requests->Length();i++) {
+        Local<Value> requestObject = requests->Get(i);
+        if (!requestObject->IsArray()) {
+            isolate->ThrowException(Exception::Error(v8string(isolate, "Request is not an array")));
+            return;
+        }
+        Local<Array> request = Local<Array>::Cast(requestObject);
+
+        // the handle could point to anything, only accept the trajectory paths of this strategy
+        Local<Value> handle = request->Get(0);
+        QTPath *wrapper = handle->IsExternal() ? static_cast<QTPath*>(Local<External>::Cast(handle)->Value()) : nullptr;
+        if (!paths.contains(wrapper) || wrapper->trajectoryPath() == nullptr) {
+            isolate->ThrowException(Exception::Error(v8string(isolate, "Invalid trajectory path handle")));
+            return;
+        }
+        TrajectoryPath *path = wrapper->trajectoryPath();
+        if (std::any_of(inputs.begin(), inputs.end(), [path](const TrajectoryPath::BatchInput &input) { return input.path == path; })) {
+            isolate->ThrowException(Exception::Error(v8string(isolate, "Trajectory path used twice in one batch")));
+            return;
+        }
+        // robot radius must have been set before
+        if (!path->world().isRadiusValid()) {
+            isolate->ThrowException(Exception::Error(v8string(isolate, "Invalid radius")));
+            return;
+        }
+
+        float v[10];
+        for (int j = 0;j<10;j++) {
+            if (!verifyNumber(isolate, request->Get(j + 1), v[j])) {
+                return;
+            }
+        }
+        TrajectoryPath::BatchInput input;
+        input.path = path;
+        input.s0 = Vector(v[0], v[1]);
+        input.v0 = Vector(v[2], v[3]);
+        input.s1 = Vector(v[4], v[5]);
+        input.v1 = Vector(v[6], v[7]);
+        input.maxSpeed = v[8];
+        input.acceleration = v[9];
+
+        Local<Value> avoidObject = request->Get(11);
+        if (!avoidObject->IsUndefined()) {
+            if (!avoidObject->IsArray()) {
+                isolate->ThrowException(Exception::Error(v8string(isolate, "Avoided trajectories must be an array")));
+                return;
+            }
+            Local<Array> avoidList = Local<Array>::Cast(avoidObject);
+            for (unsigned int j = 0;j<avoidList->Length();j++) {
+                Local<Value> avoidEntry = avoidList->Get(j);
+                if (!avoidEntry->IsArray()) {
+                    isolate->ThrowException(Exception::Error(v8string(isolate, "Avoided trajectory is not an array")));
+                    return;
+                }
+                Local<Array> avoid = Local<Array>::Cast(avoidEntry);
+                float index, prio, radius;
+                if (!verifyNumber(isolate, avoid->Get(0), index) || !verifyNumber(isolate, avoid->Get(1), prio) ||
+                        !verifyNumber(isolate, avoid->Get(2), radius)) {
+                    return;
+                }
+                if (index < 0 || index >= float(i)) {
+                    isolate->ThrowException(Exception::Error(v8string(isolate, "Can only avoid trajectories of earlier requests")));
+                    return;
+                }
+                input.avoid.push_back({int(index), int(prio), radius});
+            }
+        }
+        inputs.push_back(input);
+    }
+
+    std::vector<std::vector<TrajectoryPoint>> trajectories = TrajectoryPath::calculateTrajectories(inputs);
+
+    Local<Array> result = Array::New(isolate, trajectories.size());
+    for (unsigned int i = 0;i<trajectories.size();i++) {
+        result->Set(i, trajectoryToJs(isolate, trajectories[i]));
+    }
+
+    ts->addPathTime((Timer::systemTime() - t) / 1E9);
+    args.GetReturnValue().Set(result);
+}
+
 static void trajectoryAddMovingCircle(const FunctionCallbackInfo<Value>& args)
 {
     Isolate * isolate = args.GetIsolate();
@@ -480,8 +680,23 @@ static QList<CallbackInfo> commonCallbacks = {
     { "addLine",            pathAddLine_new},
     { "addRect",            pathAddRect_new},
     { "addTriangle",        pathAddTriangle_new},
+    { "updateCircle",       pathUpdateCircle},
+    { "updateRect",         pathUpdateRect},
+    { "addObstacleSet",     pathAddObstacleSet},
+    { "removeObstacleSet",  pathRemoveObstacleSet},
+    { "clearStaticObstacles", pathClearStaticObstacles},
     { "seedRandom",         pathSeedRandom}};
 
+static QList<CallbackInfo> obstacleSetCallbacks = {
+    { "clearObstacles",     pathClearObstacles_new},
+    { "addCircle",          pathAddCircle_new},
+    { "addLine",            pathAddLine_new},
+    { "addRect",            pathAddRect_new},
+    { "addTriangle",        pathAddTriangle_new},
+    { "updateCircle",       pathUpdateCircle},
+    { "updateRect",         pathUpdateRect},
+    { "getHandle",          obstacleSetGetHandle}};
+
 static QList<CallbackInfo> rrtPathCallbacks = {
     { "setProbabilities",   pathSetProbabilities_new},
     { "addSeedTarget",      pathAddSeedTarget_new},
@@ -497,7 +712,9 @@ static QList<CallbackInfo> trajectoryPathCallbacks = {
     { "getTrajectoryAsObstacle", trajectoryGetLastTrajectoryAsRobotObstacle},
     { "addRobotTrajectoryObstacle", trajectoryAddRobotTrajectoryObstacle},
     { "maxIntersectingObstaclePrio", trajectoryMaxIntersectingObstaclePrio},
-    { "setRobotId",         trajectorySetRobotId}};
+    { "setRobotId",         trajectorySetRobotId},
+    { "clearMovingObstacles", trajectoryClearMovingObstacles},
+    { "getBatchHandle",     trajectoryGetBatchHandle}};
 
 static void pathCreateNew(const FunctionCallbackInfo<Value>& args)
 {
@@ -551,6 +768,18 @@ static void trajectoryPathCreateNew(const FunctionCallbackInfo<Value>& args)
     args.GetReturnValue().Set(pathWrapper);
 }
 
+// static obstacles that are shared by several paths, e.g. the field boundaries and defense areas
+static void pathCreateObstacleSet(const FunctionCallbackInfo<Value>& args)
+{
+    Isolate* isolate = args.GetIsolate();
+    Typescript *ts = static_cast<QTPath*>(Local<External>::Cast(args.Data())->Value())->typescript();
+    QTPath *p = new QTPath(nullptr, nullptr, ts, new WorldInformation);
+
+    Local<Object> setWrapper = Object::New(isolate);
+    installCallbacks(isolate, setWrapper, obstacleSetCallbacks, External::New(isolate, p));
+    args.GetReturnValue().Set(setWrapper);
+}
+
 static void pathCreateOld(const FunctionCallbackInfo<Value>& args)
 {
     Isolate* isolate = args.GetIsolate();
@@ -564,6 +793,8 @@ void registerPathJsCallbacks(Isolate *isolate, Local<Object> global, Typescript
     QList<CallbackInfo> callbacks = {
         { "createPath",         pathCreateNew},
         { "createTrajectoryPath", trajectoryPathCreateNew},
+        { "calculateTrajectories", pathCalculateTrajectories},
+        { "createObstacleSet",  pathCreateObstacleSet},
         // legacy functions, kept for backwards compatibility
         { "create",             pathCreateOld},
         { "destroy",            pathDestroy_legacy},
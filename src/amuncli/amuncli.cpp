@@ -49,6 +49,7 @@ int main(int argc, char* argv[])
     QCommandLineOption recordLog({"r", "record"}, "Record the game to the specified log file", "file");
     QCommandLineOption reportEvents({"e", "report-events"}, "Report the number of events (fouls, goals etc.)");
     QCommandLineOption simulationSpeed("simulation-speed", "Speed in percent to run the simulator at. Defaults to 100%", "speed", "100");
+    QCommandLineOption asFastAsPossible("as-fast-as-possible", "Run simulator, tracking and strategies in lockstep as fast as the cpu allows, instead of a fixed speed");
     QCommandLineOption backlog({"b", "backlog-directory"}, "Directory for backlogging of events.", "directory");
     QCommandLineOption maxBacklog("max-backlog", "Maximum of backlog files in a category. 0 removes limit. Default 20.", "count");
     QCommandLineOption realismConfig("realism", "Simulator realism configuration (short file name without the .txt)", "realism");
@@ -62,6 +63,7 @@ int main(int argc, char* argv[])
     parser.addOption(recordLog);
     parser.addOption(reportEvents);
     parser.addOption(simulationSpeed);
+    parser.addOption(asFastAsPossible);
     parser.addOption(backlog);
     parser.addOption(maxBacklog);
     parser.addOption(realismConfig);
@@ -89,6 +91,12 @@ int main(int argc, char* argv[])
     bool debug = parser.isSet(debugOption);
     int simulationRunningTime = parser.value(simulationTime).toInt();
     int numRobots = parser.value(numberOfRobots).toInt();
+    bool lockstep = parser.isSet(asFastAsPossible);
+
+    if (lockstep && parser.isSet(simulationSpeed)) {
+        std::cerr <<"Options simulation-speed and as-fast-as-possible can not be combined"<<std::endl;
+        exit(1);
+    }
 
     Connector connector;
 
@@ -96,7 +104,7 @@ int main(int argc, char* argv[])
     connector.compileStrategy(app, initScript);
 
     AmunClient amun;
-    amun.start(true);
+    amun.start(true, lockstep);
 
     connector.connect(&connector, &Connector::sendCommand, &amun, &AmunClient::sendCommand);
     connector.connect(&amun, &AmunClient::gotStatus, &connector, &Connector::handleStatus);
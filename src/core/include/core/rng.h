@@ -31,6 +31,8 @@ public:
 
 public:
     void seed(uint32_t seed);
+    // derives the seed of an independent generator, only depends on the given seed and stream
+    static uint32_t streamSeed(uint32_t seed, uint64_t stream);
     uint32_t uniformInt();
     double uniform();
     double uniformPositive();
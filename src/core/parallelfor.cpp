@@ -0,0 +1,83 @@
+/***************************************************************************
+ *   Copyright 2021                                                        *
+ *   Robotics Erlangen e.V.                                                *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "parallelfor.h"
+#include <QAtomicInt>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <algorithm>
+
+namespace {
+    struct ParallelForState
+    {
+        ParallelForState(int count, const std::function<void(int)> *body) : count(count), body(body) {}
+
+        const int count;
+        // only valid as long as the call to parallelFor is running
+        // it is only dereferenced after claiming an index below count, whose completion parallelFor waits for
+        const std::function<void(int)> *body;
+        // the next unclaimed index, every worker claims a single index at a time
+        QAtomicInt next;
+        QSemaphore finished;
+    };
+
+    // claims and runs indices until all of them are claimed, a worker that starts late
+    // only sees next >= count and returns without touching body
+    void work(ParallelForState &state)
+    {
+        int index;
+        while ((index = state.next.fetchAndAddRelaxed(1)) < state.count) {
+            (*state.body)(index);
+            state.finished.release();
+        }
+    }
+
+    class ParallelForTask : public QRunnable
+    {
+    public:
+        explicit ParallelForTask(const QSharedPointer<ParallelForState> &state) : m_state(state) {}
+        void run() override { work(*m_state); }
+
+    private:
+        // helpers may only be started by the pool after parallelFor has already returned,
+        // thus they share ownership of the state
+        QSharedPointer<ParallelForState> m_state;
+    };
+}
+
+void parallelFor(int count, const std::function<void(int)> &body, QThreadPool *pool)
+{
+    if (count <= 0) {
+        return;
+    }
+    if (pool == nullptr) {
+        pool = QThreadPool::globalInstance();
+    }
+
+    QSharedPointer<ParallelForState> state(new ParallelForState(count, &body));
+    const int helpers = std::min(count - 1, pool->maxThreadCount());
+    for (int i = 0; i < helpers; i++) {
+        pool->start(new ParallelForTask(state));
+    }
+    work(*state);
+    state->finished.acquire(count);
+}
@@ -69,6 +69,24 @@ void RNG::seed(uint32_t s)
     }
 }
 
+/*!
+ * \brief Derive the seed for one of multiple independent random number streams
+ *
+ * Uses the SplitMix64 finalizer, thus neighbouring streams or seeds yield unrelated seeds.
+ * \param seed Common seed of all streams
+ * \param stream Id of the stream
+ * \return Seed for the stream
+ */
+uint32_t RNG::streamSeed(uint32_t seed, uint64_t stream)
+{
+    uint64_t z = (static_cast<uint64_t>(seed) << 32) ^ (stream * 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    const uint32_t result = static_cast<uint32_t>((z ^ (z >> 31)) >> 32);
+    // the constructor would replace 0 with a time based seed
+    return result != 0 ? result : 1;
+}
+
 /*!
  * \brief Generate a random integer in the range [0, 2^32-1]
  * \return A random number drawn from a uniform distribution [0, 2^32-1]
@@ -24,19 +24,28 @@
 #include <QNetworkDatagram>
 #include <QCommandLineParser>
 #include <QTime>
+#include <QTimer>
+#include <QSemaphore>
 #include <cmath>
 #include <cstdio>
 #include <cstdarg>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <functional>
 
 #include "protobuf/ssl_simulation_robot_control.pb.h"
 #include "protobuf/ssl_simulation_robot_feedback.pb.h"
 #include "protobuf/ssl_simulation_custom_erforce_robot_spec.pb.h"
+#include "protobuf/ssl_simulation_custom_erforce_lockstep.pb.h"
+#include "protobuf/ssl_simulation_custom_erforce_feedback.pb.h"
 #include "protobuf/sslsim.h"
 #include "protobuf/status.h"
 #include "protobuf/command.h"
 #include "protobuf/geometry.h"
 #include "protobuf/robot.h"
 #include "simulator/simulator.h"
+#include "simulator/fastsimulator.h"
 
 #include "core/timer.h"
 #include "core/run_out_of_scope.h"
@@ -48,6 +57,9 @@
 static int BLUE_PORT = 10301;
 static int YELLOW_PORT = 10302;
 static int CONTROL_PORT = 10300;
+static int VISION_PORT = 10020;
+// every further instance uses the next block of control and team ports and the next vision port
+static int INSTANCE_PORT_STRIDE = 3;
 
 
 /**
@@ -62,6 +74,20 @@ static int CONTROL_PORT = 10300;
  *  - [ ]: Dribbler will reset if a new command doesn't contain a new dribbling speed (contrary to the definition that states all not set values should stay as previously assumed)
  *  - [ ]: Commands that are recieved at t0 will not be in effect after the next tick of the simulator (around 5 ms), no interpolation.
  *  - [ ]: Tournament mode where commands origin are checked is not implemented
+ *
+ * Lockstep mode (--lockstep):
+ *  The simulation time only advances on request. The control port then expects sslsim::LockstepRequest messages,
+ *  each one is answered with a sslsim::LockstepResponse containing the vision packets and robot feedback of the step.
+ *  The team ports are not opened and no vision packets are multicast in this mode.
+ *
+ * Compact feedback (--compact-feedback):
+ *  The team ports reply with sslsim::RobotFeedbackStream instead of sslsim::RobotControlResponse.
+ *  It contains the feedback of all robots of a tick in one datagram, but only the fields that changed.
+ *
+ * Multiple instances (--instances K):
+ *  Hosts K independent simulators in one process, spread over the available cores.
+ *  Instance i uses the ports CONTROL_PORT, BLUE_PORT and YELLOW_PORT offset by i * INSTANCE_PORT_STRIDE
+ *  and the vision port VISION_PORT + i.
  */
 
 // Check log format strings
@@ -91,49 +117,67 @@ public:
 public slots:
     void sendVisionData(const QByteArray& data, qint64 time, QString sender);
 
+private slots:
+    void sendPendingPackets();
+
 private:
     RoboCupSSLServer m_server;
+    QList<QByteArray> m_pendingPackets;
 };
 
+class SimProxy;
+
 class SimulatorCommandAdaptor: public QObject {
     Q_OBJECT
 public:
-    SimulatorCommandAdaptor(Timer* timer, SSLVisionServer *vision);
+    // lockstepSim has to be set to accept lockstep requests instead of plain simulator commands
+    SimulatorCommandAdaptor(Timer* timer, SSLVisionServer *vision, int port, SimProxy *lockstepSim = nullptr);
 private slots:
     void handleDatagrams();
 
 public slots:
     void handleSimulatorError(const QList<SSLSimError> &error, camun::simulator::ErrorSource source);
+    void handleVisionPacket(const QByteArray& data, qint64 time, QString sender);
+    void handleRobotResponse(const QList<robot::RadioResponse>& responses);
 
 signals:
     void sendCommand(const Command& c);
+    void sendRadioCommands(const SSLSimRobotControl & commands, bool isBlue, qint64 processingDelay);
 
 private:
+    void handleSimulatorCommand(const sslsim::SimulatorCommand& simcom, google::protobuf::RepeatedPtrField<sslsim::SimulatorError>* errors);
+    void handleLockstepRequest(const QByteArray& data);
+
     QUdpSocket m_server;
     QHostAddress m_senderAddress;
     int m_senderPort;
     Timer* m_timer; // unowned
     SSLVisionServer* m_visionServer; // unowned
+    SimProxy* m_lockstepSim; // unowned
+    // collects everything that happens during a lockstep request
+    sslsim::LockstepResponse m_lockstepResponse;
 };
 
-SimulatorCommandAdaptor::SimulatorCommandAdaptor(Timer* timer, SSLVisionServer* vision):
+SimulatorCommandAdaptor::SimulatorCommandAdaptor(Timer* timer, SSLVisionServer* vision, int port, SimProxy* lockstepSim):
     m_server(this),
     m_senderAddress(QHostAddress::Null),
     m_senderPort(-1),
     m_timer(timer),
-    m_visionServer(vision)
+    m_visionServer(vision),
+    m_lockstepSim(lockstepSim)
 {
-    m_server.bind(QHostAddress::Any, CONTROL_PORT);
+    m_server.bind(QHostAddress::Any, port);
     connect(&m_server, &QUdpSocket::readyRead, this, &SimulatorCommandAdaptor::handleDatagrams);
 }
 
 class RobotCommandAdaptor: public QObject{
     Q_OBJECT
 public:
-    RobotCommandAdaptor(bool blue, Timer* timer);
+    RobotCommandAdaptor(bool blue, Timer* timer, int port, bool compactFeedback = false);
 
 private:
     void sendRobotRespose(const sslsim::RobotControlResponse& rcr);
+    void sendCompactFeedback(const QList<robot::RadioResponse>& responses);
 
 public slots:
     void handleRobotResponse(const QList<robot::RadioResponse>& responses);
@@ -147,20 +191,37 @@ signals:
 
 
 private:
+    struct FeedbackState {
+        bool ballContact;
+        bool kickerReady;
+    };
+
     bool m_is_blue;
     QUdpSocket m_server;
     QHostAddress m_senderAddress;
     int m_senderPort;
     Timer* m_timer; // unowned
+
+    const bool m_compactFeedback;
+    // last state sent to the client per robot id
+    QMap<uint, FeedbackState> m_sentFeedback;
+    quint32 m_feedbackSequence;
+    int m_deltasSinceKeyframe;
 };
 
-RobotCommandAdaptor::RobotCommandAdaptor(bool blue, Timer* timer): m_is_blue(blue),
+// allows the client to recover from lost datagrams, in datagrams
+static const int FEEDBACK_KEYFRAME_INTERVAL = 100;
+
+RobotCommandAdaptor::RobotCommandAdaptor(bool blue, Timer* timer, int port, bool compactFeedback): m_is_blue(blue),
     m_server(this),
     m_senderAddress(QHostAddress::Null),
     m_senderPort(-1),
-    m_timer(timer)
+    m_timer(timer),
+    m_compactFeedback(compactFeedback),
+    m_feedbackSequence(0),
+    m_deltasSinceKeyframe(FEEDBACK_KEYFRAME_INTERVAL)
 {
-    m_server.bind(QHostAddress::Any, (blue)? BLUE_PORT : YELLOW_PORT);
+    m_server.bind(QHostAddress::Any, port);
     connect(&m_server, &QUdpSocket::readyRead, this, &RobotCommandAdaptor::handleDatagrams);
 }
 
@@ -170,6 +231,7 @@ enum class SimError {
     UNREADABLE,
     MISSING_SPEC,
     INVALID_REALISM,
+    INVALID_STEP,
 };
 
 enum class SimErrorSource {
@@ -202,6 +264,10 @@ static void setError(sslsim::SimulatorError* error, SimError code, SimErrorSourc
             codeStr = "INVALID_REALISM";
             message = "The received realism is not conforming to the realism configuration for this simulator " + appendix;
             break;
+        case SimError::INVALID_STEP:
+            codeStr = "INVALID_STEP";
+            message = "The requested simulation step is negative " + appendix;
+            break;
         default:
             log(stderr, "Unmanaged SimError for message\n");
             break;
@@ -248,6 +314,36 @@ static void warnLatency(qint64 delta) {
     }
 }
 
+// @return false: the control contains commands this simulator does not support, the commands are still applied
+static bool checkRobotControl(const sslsim::RobotControl& control, SimErrorSource source, google::protobuf::RepeatedPtrField<sslsim::SimulatorError>* errors) {
+    bool valid = true;
+    for (const auto& command : control.robot_commands()) {
+        if (command.has_move_command()) {
+            const auto& moveCmd = command.move_command();
+            if (moveCmd.has_wheel_velocity() || moveCmd.has_global_velocity()) {
+                valid = false;
+                const std::string robotStr = "(Robot :" + std::to_string(command.id()) + ")";
+                setError(errors->Add(), SimError::UNSUPPORTED_VELOCITY, source, robotStr);
+            }
+        }
+    }
+    return valid;
+}
+
+// @return true: feedback for at least one robot was added
+static bool addRobotFeedback(const QList<robot::RadioResponse>& responses, bool isBlue, sslsim::RobotControlResponse* out) {
+    bool added = false;
+    for (const auto& response : responses) {
+        if (response.has_is_blue() && response.is_blue() == isBlue && response.has_ball_detected()) {
+            auto* outFeedback = out->add_feedback();
+            outFeedback->set_id(response.id());
+            outFeedback->set_dribbler_ball_contact(response.ball_detected());
+            added = true;
+        }
+    }
+    return added;
+}
+
 
 //TODO: Always update the following constant if the robotSpecs did change,
 // either disregard the new field and just increase the expected number if the new field is useless to our simulator,
@@ -373,100 +469,107 @@ void SimulatorCommandAdaptor::handleDatagrams() {
     while(m_server.hasPendingDatagrams()) {
         qint64 start = m_timer->currentTime();
         auto datagram = m_server.receiveDatagram();
-        sslsim::SimulatorResponse sir;
-        bool sendSir = false;
         m_senderAddress = datagram.senderAddress();
         m_senderPort = datagram.senderPort();
         auto data = datagram.data();
 
+        if (m_lockstepSim) {
+            handleLockstepRequest(data);
+            continue;
+        }
+
+        sslsim::SimulatorResponse sir;
         RUN_WHEN_OUT_OF_SCOPE({
-                if (sendSir) {
+                if (sir.errors_size() > 0) {
                     sendUDP(sir, m_server, m_senderAddress, m_senderPort);
                 }
             });
         sslsim::SimulatorCommand simcom;
         if (!simcom.ParseFromArray(data.data(), data.size())) {
-            sendSir = true;
             setError(sir.add_errors(), SimError::UNREADABLE, SimErrorSource::CONTROLLER);
             continue;
         }
-        if (simcom.has_control()) {
+        handleSimulatorCommand(simcom, sir.mutable_errors());
+
+        qint64 delta = m_timer->currentTime() - start;
+        warnLatency(delta);
+    }
+}
+
+void SimulatorCommandAdaptor::handleSimulatorCommand(const sslsim::SimulatorCommand& simcom, google::protobuf::RepeatedPtrField<sslsim::SimulatorError>* errors)
+{
+    if (simcom.has_control()) {
+        Command c{new amun::Command};
+        auto* sslControl = c->mutable_simulator()->mutable_ssl_control();
+        sslControl->CopyFrom(simcom.control());
+        if (sslControl->has_teleport_ball()) {
+            auto* teleportBall = sslControl->mutable_teleport_ball();
+            SCALE_UP(*teleportBall, x);
+            SCALE_UP(*teleportBall, y);
+            SCALE_UP(*teleportBall, z);
+            SCALE_UP(*teleportBall, vx);
+            SCALE_UP(*teleportBall, vy);
+            SCALE_UP(*teleportBall, vz);
+        }
+        for(sslsim::TeleportRobot& robot : *sslControl->mutable_teleport_robot()) {
+            SCALE_UP(robot, x);
+            SCALE_UP(robot, y);
+            SCALE_UP(robot, v_x);
+            SCALE_UP(robot, v_y);
+        }
+        emit sendCommand(c);
+    }
+    if (simcom.has_config()) {
+        const auto& config{simcom.config()};
+
+        if (config.has_geometry()) {
             Command c{new amun::Command};
-            auto* sslControl = c->mutable_simulator()->mutable_ssl_control();
-            sslControl->CopyFrom(simcom.control());
-            if (sslControl->has_teleport_ball()) {
-                auto* teleportBall = sslControl->mutable_teleport_ball();
-                SCALE_UP(*teleportBall, x);
-                SCALE_UP(*teleportBall, y);
-                SCALE_UP(*teleportBall, z);
-                SCALE_UP(*teleportBall, vx);
-                SCALE_UP(*teleportBall, vy);
-                SCALE_UP(*teleportBall, vz);
-            }
-            for(sslsim::TeleportRobot& robot : *sslControl->mutable_teleport_robot()) {
-                SCALE_UP(robot, x);
-                SCALE_UP(robot, y);
-                SCALE_UP(robot, v_x);
-                SCALE_UP(robot, v_y);
-            }
+            auto* setup = c->mutable_simulator()->mutable_simulator_setup();
+            convertFromSSlGeometry(config.geometry().field(), *(setup->mutable_geometry()));
+            setup->mutable_camera_setup()->CopyFrom(config.geometry().calib());
             emit sendCommand(c);
         }
-        if (simcom.has_config()) {
-            const auto& config{simcom.config()};
-
-            if (config.has_geometry()) {
-                Command c{new amun::Command};
-                auto* setup = c->mutable_simulator()->mutable_simulator_setup();
-                convertFromSSlGeometry(config.geometry().field(), *(setup->mutable_geometry()));
-                setup->mutable_camera_setup()->CopyFrom(config.geometry().calib());
-                emit sendCommand(c);
-            }
 
-            if (config.robot_specs_size() > 0) {
-                Command c{new amun::Command};
-                robot::Team* blueTeam = nullptr;
-                robot::Team* yellowTeam = nullptr;
-                auto newSz = config.robot_specs_size();
-                for (const auto& spec : config.robot_specs()) {
-                    bool success = convertSpecsToErForce([&blueTeam, &yellowTeam, &c](bool isBlue){
-                            if (isBlue) {
-                                if (blueTeam == nullptr) {
-                                    blueTeam = c->mutable_set_team_blue();
-                                }
-                                return blueTeam->add_robot();
-                            }
-                            if (yellowTeam == nullptr) {
-                                yellowTeam = c->mutable_set_team_yellow();
-                            }
-                            return yellowTeam->add_robot();
+        if (config.robot_specs_size() > 0) {
+            Command c{new amun::Command};
+            robot::Team* blueTeam = nullptr;
+            robot::Team* yellowTeam = nullptr;
+            auto newSz = config.robot_specs_size();
+            for (const auto& spec : config.robot_specs()) {
+                bool success = convertSpecsToErForce([&blueTeam, &yellowTeam, &c](bool isBlue){
+                        if (isBlue) {
+                            if (blueTeam == nullptr) {
+                                blueTeam = c->mutable_set_team_blue();
                             }
-                            , spec);
-                    if (!success) {
-                        sendSir = true;
-                        setError(sir.add_errors(), SimError::MISSING_SPEC, SimErrorSource::CONTROLLER, spec.DebugString());
-                        newSz--;
-                    }
+                            return blueTeam->add_robot();
+                        }
+                        if (yellowTeam == nullptr) {
+                            yellowTeam = c->mutable_set_team_yellow();
+                        }
+                        return yellowTeam->add_robot();
+                        }
+                        , spec);
+                if (!success) {
+                    setError(errors->Add(), SimError::MISSING_SPEC, SimErrorSource::CONTROLLER, spec.DebugString());
+                    newSz--;
                 }
-                log(stdout, "Updated to %d robots\n", newSz);
-                emit sendCommand(c);
             }
-            if (config.has_realism_config()) {
-                for(const auto& c : config.realism_config().custom()) {
-                RealismConfigErForce rcef;
-                    if (c.UnpackTo(&rcef)) {
-                        Command c{new amun::Command};
-                        c->mutable_simulator()->mutable_realism_config()->CopyFrom(rcef);
-                        emit sendCommand(c);
-                    }
+            log(stdout, "Updated to %d robots\n", newSz);
+            emit sendCommand(c);
+        }
+        if (config.has_realism_config()) {
+            for(const auto& c : config.realism_config().custom()) {
+            RealismConfigErForce rcef;
+                if (c.UnpackTo(&rcef)) {
+                    Command c{new amun::Command};
+                    c->mutable_simulator()->mutable_realism_config()->CopyFrom(rcef);
+                    emit sendCommand(c);
                 }
             }
-            if (config.has_vision_port()) {
-                m_visionServer->setPort(config.vision_port());
-            }
         }
-
-        qint64 delta = m_timer->currentTime() - start;
-        warnLatency(delta);
+        if (config.has_vision_port()) {
+            m_visionServer->setPort(config.vision_port());
+        }
     }
 }
 
@@ -488,6 +591,19 @@ void RobotCommandAdaptor::handleSimulatorError(const QList<SSLSimError> &error,c
 }
 
 void SimulatorCommandAdaptor::handleSimulatorError(const QList<SSLSimError> &error, camun::simulator::ErrorSource source) {
+    if (m_lockstepSim) {
+        // reported with the reply to the current request
+        google::protobuf::RepeatedPtrField<sslsim::SimulatorError>* errors = m_lockstepResponse.mutable_errors();
+        if (source == camun::simulator::ErrorSource::BLUE) {
+            errors = m_lockstepResponse.mutable_blue_feedback()->mutable_errors();
+        } else if (source == camun::simulator::ErrorSource::YELLOW) {
+            errors = m_lockstepResponse.mutable_yellow_feedback()->mutable_errors();
+        }
+        for (const SSLSimError& err : error) {
+            errors->Add()->CopyFrom(*err);
+        }
+        return;
+    }
     if (source != camun::simulator::ErrorSource::CONFIG) return;
     if (error.size() == 0) return;
     sslsim::SimulatorResponse sir;
@@ -509,6 +625,10 @@ void RobotCommandAdaptor::handleDatagrams()
         bool sendRcr = false;
         auto datagram = m_server.receiveDatagram();
         // TODO: do something with m_senderAddress and datagram.senderAddress
+        if (datagram.senderAddress() != m_senderAddress || datagram.senderPort() != m_senderPort) {
+            // a new client knows nothing about the previous feedback
+            m_deltasSinceKeyframe = FEEDBACK_KEYFRAME_INTERVAL;
+        }
         m_senderAddress = datagram.senderAddress();
         m_senderPort = datagram.senderPort();
         auto data = datagram.data();
@@ -526,15 +646,8 @@ void RobotCommandAdaptor::handleDatagrams()
             continue;
         }
 
-        for (const auto& command : control->robot_commands()) {
-            if (command.has_move_command()) {
-                const auto& moveCmd = command.move_command();
-                if (moveCmd.has_wheel_velocity() || moveCmd.has_global_velocity()) {
-                    sendRcr = true;
-                    const std::string robotStr = "(Robot :" + std::to_string(command.id()) + ")";
-                    setError(rcr.add_errors(), SimError::UNSUPPORTED_VELOCITY, ERROR_SOURCE, robotStr);
-                }
-            }
+        if (!checkRobotControl(*control, ERROR_SOURCE, rcr.mutable_errors())) {
+            sendRcr = true;
         }
         emit sendRadioCommands(control, m_is_blue, m_timer->currentTime()); // This might be a bit late.
         // TODO: response!
@@ -549,24 +662,76 @@ void RobotCommandAdaptor::handleRobotResponse(const QList<robot::RadioResponse>&
         return;
     }
 
+    if (m_compactFeedback) {
+        sendCompactFeedback(res);
+        return;
+    }
+
     sslsim::RobotControlResponse out;
-    bool send = false;
+    if (addRobotFeedback(res, m_is_blue, &out)) {
+        sendRobotRespose(out);
+    }
+}
+
+void RobotCommandAdaptor::sendCompactFeedback(const QList<robot::RadioResponse>& res) {
+    const bool keyframe = m_deltasSinceKeyframe >= FEEDBACK_KEYFRAME_INTERVAL;
+    sslsim::RobotFeedbackStream out;
 
     for (const auto& response : res) {
-        if (response.has_is_blue() && response.is_blue() == m_is_blue && response.has_ball_detected()) {
-            auto* outFeedback = out.add_feedback();
-            outFeedback->set_id(response.id());
-            outFeedback->set_dribbler_ball_contact(response.ball_detected());
-            send = true;
+        if (!response.has_is_blue() || response.is_blue() != m_is_blue) {
+            continue;
+        }
+        const FeedbackState state{response.ball_detected(), response.cap_charged()};
+        const auto sent = m_sentFeedback.constFind(response.id());
+        const bool known = sent != m_sentFeedback.constEnd();
+        const bool contactChanged = !known || sent->ballContact != state.ballContact;
+        const bool kickerChanged = !known || sent->kickerReady != state.kickerReady;
+        m_sentFeedback[response.id()] = state;
+
+        // keyframes are completed below
+        if (keyframe || (!contactChanged && !kickerChanged)) {
+            continue;
+        }
+        auto* feedback = out.add_feedback();
+        feedback->set_id(response.id());
+        if (contactChanged) {
+            feedback->set_dribbler_ball_contact(state.ballContact);
+        }
+        if (kickerChanged) {
+            feedback->set_kicker_ready(state.kickerReady);
         }
     }
 
-    if (send) {
-        sendRobotRespose(out);
+    if (keyframe) {
+        if (m_sentFeedback.isEmpty()) {
+            return;
+        }
+        out.set_keyframe(true);
+        for (auto it = m_sentFeedback.constBegin(); it != m_sentFeedback.constEnd(); ++it) {
+            auto* feedback = out.add_feedback();
+            feedback->set_id(it.key());
+            feedback->set_dribbler_ball_contact(it->ballContact);
+            feedback->set_kicker_ready(it->kickerReady);
+        }
+        m_deltasSinceKeyframe = 0;
+    } else if (out.feedback_size() == 0) {
+        return;
+    } else {
+        m_deltasSinceKeyframe++;
     }
+
+    out.set_sequence(m_feedbackSequence++);
+    sendUDP(out, m_server, m_senderAddress, m_senderPort);
 }
 
 void RobotCommandAdaptor::sendRobotRespose(const sslsim::RobotControlResponse& out) {
+    if (m_compactFeedback) {
+        // only errors are sent this way, they are not part of the feedback sequence
+        sslsim::RobotFeedbackStream stream;
+        stream.mutable_errors()->CopyFrom(out.errors());
+        sendUDP(stream, m_server, m_senderAddress, m_senderPort);
+        return;
+    }
     sendUDP(out, m_server, m_senderAddress, m_senderPort);
 }
 
@@ -577,7 +742,17 @@ SSLVisionServer::SSLVisionServer(int port): m_server(this, port)
 
 void SSLVisionServer::sendVisionData(const QByteArray& data, qint64, QString)
 {
-    m_server.send(data);
+    // the packets of all cameras are queued back to back, send them with a single call
+    if (m_pendingPackets.isEmpty()) {
+        QMetaObject::invokeMethod(this, "sendPendingPackets", Qt::QueuedConnection);
+    }
+    m_pendingPackets.append(data);
+}
+
+void SSLVisionServer::sendPendingPackets()
+{
+    m_server.send(m_pendingPackets);
+    m_pendingPackets.clear();
 }
 
 void SSLVisionServer::setPort(int port) {
@@ -590,7 +765,9 @@ using camun::simulator::ErrorSource;
 class SimProxy: public QObject {
     Q_OBJECT
 public:
-    SimProxy(Timer* t): m_timer(t) {}
+    // in lockstep mode the simulation only advances by calling step
+    SimProxy(Timer* t, bool lockstep = false): m_timer(t), m_lockstep(lockstep) {}
+    void step(qint64 delta);
 signals:
     void sendSSLSimError(const QList<SSLSimError>& errors, ErrorSource source); // out
     void sendRadioResponses(const QList<robot::RadioResponse> &responses); // out
@@ -602,6 +779,7 @@ public slots:
 
 private:
     Timer* m_timer;
+    const bool m_lockstep;
     Simulator* m_sim = nullptr;
     Command m_teamCommand{new amun::Command};
 };
@@ -634,7 +812,7 @@ void SimProxy::handleCommand(const Command &command) {
             m_sim->blockSignals(true);
             m_sim->deleteLater();
         }
-        m_sim = new Simulator(m_timer, command->simulator().simulator_setup());
+        m_sim = new Simulator(m_timer, command->simulator().simulator_setup(), m_lockstep);
         connect(this, &SimProxy::gotCommand, m_sim, &Simulator::handleCommand);
         connect(m_sim, &Simulator::gotPacket, this, &SimProxy::gotPacket);
         connect(this, &SimProxy::handleRadioCommands, m_sim, &Simulator::handleRadioCommands);
@@ -649,6 +827,166 @@ void SimProxy::handleCommand(const Command &command) {
     emit gotCommand(command);
 }
 
+void SimProxy::step(qint64 delta) {
+    if (m_sim != nullptr) {
+        FastSimulator::goDelta(m_sim, m_timer, delta);
+    }
+}
+
+void SimulatorCommandAdaptor::handleLockstepRequest(const QByteArray& data) {
+    m_lockstepResponse.Clear();
+    RUN_WHEN_OUT_OF_SCOPE({
+            m_lockstepResponse.set_time(m_timer->currentTime());
+            sendUDP(m_lockstepResponse, m_server, m_senderAddress, m_senderPort);
+        });
+
+    sslsim::LockstepRequest request;
+    if (!request.ParseFromArray(data.data(), data.size())) {
+        setError(m_lockstepResponse.add_errors(), SimError::UNREADABLE, SimErrorSource::CONTROLLER);
+        return;
+    }
+    if (request.delta_time_ns() < 0) {
+        setError(m_lockstepResponse.add_errors(), SimError::INVALID_STEP, SimErrorSource::CONTROLLER);
+        return;
+    }
+    if (request.has_command()) {
+        handleSimulatorCommand(request.command(), m_lockstepResponse.mutable_errors());
+    }
+
+    // stamped just before the current time, thus the commands are in effect from the first step on
+    const qint64 commandTime = m_timer->currentTime() - 1;
+    if (request.has_blue_control()) {
+        SSLSimRobotControl control{new sslsim::RobotControl(request.blue_control())};
+        checkRobotControl(*control, SimErrorSource::BLUE_TEAM, m_lockstepResponse.mutable_blue_feedback()->mutable_errors());
+        emit sendRadioCommands(control, true, commandTime);
+    }
+    if (request.has_yellow_control()) {
+        SSLSimRobotControl control{new sslsim::RobotControl(request.yellow_control())};
+        checkRobotControl(*control, SimErrorSource::YELLOW_TEAM, m_lockstepResponse.mutable_yellow_feedback()->mutable_errors());
+        emit sendRadioCommands(control, false, commandTime);
+    }
+
+    // the simulator runs in this thread, thus everything it emits is collected into m_lockstepResponse directly
+    m_lockstepSim->step(request.delta_time_ns());
+}
+
+void SimulatorCommandAdaptor::handleVisionPacket(const QByteArray& data, qint64, QString) {
+    m_lockstepResponse.add_vision_packets(data.data(), data.size());
+}
+
+void SimulatorCommandAdaptor::handleRobotResponse(const QList<robot::RadioResponse>& responses) {
+    addRobotFeedback(responses, true, m_lockstepResponse.mutable_blue_feedback());
+    addRobotFeedback(responses, false, m_lockstepResponse.mutable_yellow_feedback());
+}
+
+// all objects belonging to a single simulated match
+class SimulatorInstance {
+public:
+    SimulatorInstance(int index, bool lockstep, bool compactFeedback);
+    SimulatorInstance(const SimulatorInstance&) = delete;
+    SimulatorInstance& operator=(const SimulatorInstance&) = delete;
+
+    // the network handling runs on receiveThread, except for lockstep mode where everything is synchronous
+    void moveToThreads(QThread* simThread, QThread* receiveThread);
+    // moves everything back into a single thread, the current threads must still be running
+    void moveToThread(QThread* target);
+    void start(const Command& initial);
+
+private:
+    const bool m_lockstep;
+    Timer m_timer;
+    SimProxy m_sim;
+    SSLVisionServer m_vision;
+    SimulatorCommandAdaptor m_commands;
+    std::unique_ptr<RobotCommandAdaptor> m_blue, m_yellow;
+};
+
+SimulatorInstance::SimulatorInstance(int index, bool lockstep, bool compactFeedback) :
+    m_lockstep(lockstep),
+    m_sim(&m_timer, lockstep),
+    m_vision(VISION_PORT + index),
+    m_commands(&m_timer, &m_vision, CONTROL_PORT + index * INSTANCE_PORT_STRIDE, lockstep ? &m_sim : nullptr)
+{
+    if (lockstep) {
+        // the time is only advanced by the lockstep requests
+        m_timer.setTime(Timer::systemTime(), 0);
+    }
+
+    m_commands.connect(&m_commands, &SimulatorCommandAdaptor::sendCommand, &m_sim, &SimProxy::handleCommand);
+    m_commands.connect(&m_sim, &SimProxy::sendSSLSimError, &m_commands, &SimulatorCommandAdaptor::handleSimulatorError);
+
+    if (lockstep) {
+        m_commands.connect(&m_commands, &SimulatorCommandAdaptor::sendRadioCommands, &m_sim, &SimProxy::handleRadioCommands);
+        m_commands.connect(&m_sim, &SimProxy::sendRadioResponses, &m_commands, &SimulatorCommandAdaptor::handleRobotResponse);
+        m_commands.connect(&m_sim, &SimProxy::gotPacket, &m_commands, &SimulatorCommandAdaptor::handleVisionPacket);
+    } else {
+        m_blue.reset(new RobotCommandAdaptor{true, &m_timer, BLUE_PORT + index * INSTANCE_PORT_STRIDE, compactFeedback});
+        m_yellow.reset(new RobotCommandAdaptor{false, &m_timer, YELLOW_PORT + index * INSTANCE_PORT_STRIDE, compactFeedback});
+        for (RobotCommandAdaptor* team : {m_blue.get(), m_yellow.get()}) {
+            team->connect(team, &RobotCommandAdaptor::sendRadioCommands, &m_sim, &SimProxy::handleRadioCommands);
+            team->connect(&m_sim, &SimProxy::sendRadioResponses, team, &RobotCommandAdaptor::handleRobotResponse);
+            team->connect(&m_sim, &SimProxy::sendSSLSimError, team, &RobotCommandAdaptor::handleSimulatorError);
+        }
+
+        m_vision.connect(&m_sim, &SimProxy::gotPacket, &m_vision, &SSLVisionServer::sendVisionData);
+    }
+}
+
+void SimulatorInstance::moveToThreads(QThread* simThread, QThread* receiveThread) {
+    // the simulator itself is created by the proxy, thus it also ends up in simThread
+    m_timer.moveToThread(simThread);
+    m_sim.moveToThread(simThread);
+    if (m_lockstep) {
+        m_vision.moveToThread(simThread);
+        m_commands.moveToThread(simThread);
+        return;
+    }
+    m_blue->moveToThread(receiveThread);
+    m_yellow->moveToThread(receiveThread);
+    m_vision.moveToThread(receiveThread);
+    m_commands.moveToThread(receiveThread);
+}
+
+// runs f in the thread of context and waits for it to finish
+static void runInThread(QObject* context, const std::function<void()>& f) {
+    if (context->thread() == QThread::currentThread()) {
+        f();
+        return;
+    }
+    QSemaphore done;
+    QTimer::singleShot(0, context, [&f, &done]() {
+        f();
+        done.release();
+    });
+    done.acquire();
+}
+
+void SimulatorInstance::moveToThread(QThread* target) {
+    // an object can only be pushed to another thread by the thread it lives in
+    runInThread(&m_sim, [this, target]() {
+        m_timer.moveToThread(target);
+        m_sim.moveToThread(target);
+        if (m_lockstep) {
+            m_vision.moveToThread(target);
+            m_commands.moveToThread(target);
+        }
+    });
+    if (!m_lockstep) {
+        runInThread(&m_commands, [this, target]() {
+            m_blue->moveToThread(target);
+            m_yellow->moveToThread(target);
+            m_vision.moveToThread(target);
+            m_commands.moveToThread(target);
+        });
+    }
+}
+
+void SimulatorInstance::start(const Command& initial) {
+    // the proxy modifies the commands it receives, every instance needs its own copy
+    Command c{new amun::Command(*initial)};
+    emit m_commands.sendCommand(c);
+}
+
 #include "simulator.moc"
 
 
@@ -675,8 +1013,14 @@ int main(int argc, char* argv[])
 
     QCommandLineOption geometryConfig({"g", "geometry"}, "The geometry file to load as default", "file", "2020");
     QCommandLineOption realismConfig("realism", "Simulator realism configuration (short file name without the .txt)", "realism", "Realistic");
+    QCommandLineOption lockstepMode("lockstep", "Only advance the simulation on request, see sslsim::LockstepRequest");
+    QCommandLineOption instancesOption("instances", "Number of independent simulators, each one uses its own ports", "count", "1");
+    QCommandLineOption compactFeedbackMode("compact-feedback", "Send only changed robot feedback, see sslsim::RobotFeedbackStream");
     parser.addOption(geometryConfig);
     parser.addOption(realismConfig);
+    parser.addOption(lockstepMode);
+    parser.addOption(instancesOption);
+    parser.addOption(compactFeedbackMode);
 
 
     parser.process(app);
@@ -698,25 +1042,23 @@ int main(int argc, char* argv[])
         log(stdout, "%s)", msg.c_str());
     }
 
-    Timer timer;
-    RobotCommandAdaptor blue{true, &timer}, yellow{false, &timer};
-    SimProxy sim{&timer};
-    SSLVisionServer vision{10020};
-    SimulatorCommandAdaptor commands{&timer, &vision};
-
-    blue.connect(&blue, &RobotCommandAdaptor::sendRadioCommands, &sim, &SimProxy::handleRadioCommands);
-    blue.connect(&sim, &SimProxy::sendRadioResponses, &blue, &RobotCommandAdaptor::handleRobotResponse);
-    yellow.connect(&yellow, &RobotCommandAdaptor::sendRadioCommands, &sim, &SimProxy::handleRadioCommands);
-    yellow.connect(&sim, &SimProxy::sendRadioResponses, &yellow, &RobotCommandAdaptor::handleRobotResponse);
-
-
-    vision.connect(&sim, &SimProxy::gotPacket, &vision, &SSLVisionServer::sendVisionData);
-    commands.connect(&commands, &SimulatorCommandAdaptor::sendCommand, &sim, &SimProxy::handleCommand);
-
+    const bool lockstep = parser.isSet(lockstepMode);
+    // lockstep mode always answers with a complete LockstepResponse
+    if (lockstep && parser.isSet(compactFeedbackMode)) {
+        log(stderr, "--compact-feedback can't be combined with --lockstep\n");
+        exit(EXIT_FAILURE);
+    }
 
-    commands.connect(&sim, &SimProxy::sendSSLSimError, &commands, &SimulatorCommandAdaptor::handleSimulatorError);
-    blue.connect(&sim, &SimProxy::sendSSLSimError, &blue, &RobotCommandAdaptor::handleSimulatorError);
-    yellow.connect(&sim, &SimProxy::sendSSLSimError, &yellow, &RobotCommandAdaptor::handleSimulatorError);
+    bool validInstances = false;
+    const int instances = parser.value(instancesOption).toInt(&validInstances);
+    if (!validInstances || instances < 1) {
+        log(stderr, "Invalid number of instances: %s\n", qPrintable(parser.value(instancesOption)));
+        exit(EXIT_FAILURE);
+    }
+    if (VISION_PORT + instances > CONTROL_PORT) {
+        log(stderr, "Too many instances, the vision ports would overlap the control ports\n");
+        exit(EXIT_FAILURE);
+    }
 
     Command c{new amun::Command};
 
@@ -741,17 +1083,47 @@ int main(int argc, char* argv[])
         exit(EXIT_FAILURE);
     }
 
-    emit commands.sendCommand(c);
-
+    // the main thread hosts the first simulators, which keeps a single instance as it always was
+    QList<QThread*> simThreads{app.thread()};
+    const int simThreadCount = std::min(instances, std::max(1, QThread::idealThreadCount()));
+    for (int i = 1; i < simThreadCount; i++) {
+        simThreads.append(new QThread(&app));
+    }
     QThread rcv_thread;
 
-    blue.moveToThread(&rcv_thread);
-    yellow.moveToThread(&rcv_thread);
-    vision.moveToThread(&rcv_thread);
-    commands.moveToThread(&rcv_thread);
-
+    std::vector<std::unique_ptr<SimulatorInstance>> sims;
+    for (int i = 0; i < instances; i++) {
+        sims.emplace_back(new SimulatorInstance(i, lockstep, parser.isSet(compactFeedbackMode)));
+        sims.back()->moveToThreads(simThreads[i % simThreadCount], &rcv_thread);
+        sims.back()->start(c);
+    }
+    if (instances > 1) {
+        log(stdout, "Started %d simulators on %d threads\n", instances, simThreadCount);
+    }
 
-    rcv_thread.start();
+    for (QThread* thread : simThreads) {
+        if (thread != app.thread()) {
+            thread->start();
+        }
+    }
+    // in lockstep mode every request is handled synchronously by the simulator thread
+    if (!lockstep) {
+        rcv_thread.start();
+    }
 
-    return app.exec();
+    const int result = app.exec();
+    // the sockets and timers of the instances must be destroyed by the thread they live in
+    for (auto& sim : sims) {
+        sim->moveToThread(app.thread());
+    }
+    sims.clear();
+    for (QThread* thread : simThreads) {
+        if (thread != app.thread()) {
+            thread->quit();
+            thread->wait();
+        }
+    }
+    rcv_thread.quit();
+    rcv_thread.wait();
+    return result;
 }
@@ -0,0 +1,326 @@
+/***************************************************************************
+ *   Copyright 2021                                                        *
+ *   Robotics Erlangen e.V.                                                *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include <clocale>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "protobuf/command.h"
+#include "protobuf/robot.h"
+#include "protobuf/sslsim.h"
+#include "simulator/simulator.h"
+#include "simulator/fastsimulator.h"
+
+#include "core/timer.h"
+#include "core/configuration.h"
+
+using camun::simulator::Simulator;
+using camun::simulator::PhaseTimings;
+
+/**
+ * Simulator throughput benchmark
+ *
+ * Runs fixed scenarios as fast as possible and reports the time spent in each phase
+ * of Simulator::process as JSON, to track regressions of the simulator across releases.
+ */
+
+enum class Behaviour {
+    IDLE,
+    DRIBBLE,
+    CHIP_STORM,
+    // all robots start in front of one goal and keep bumping into each other
+    CROWD
+};
+
+struct Scenario {
+    QString name;
+    Behaviour behaviour;
+    // 0 uses the cameras of the simulator configuration
+    int cameraCount;
+};
+
+static const int ROBOTS_PER_TEAM = 11;
+
+static const QList<Scenario> SCENARIOS = {
+    {"idle", Behaviour::IDLE, 0},
+    {"dribble", Behaviour::DRIBBLE, 0},
+    {"chip-storm", Behaviour::CHIP_STORM, 0},
+    {"cameras-16", Behaviour::IDLE, 16},
+    {"penalty-crowd", Behaviour::CROWD, 0},
+};
+
+static void setCameraGrid(amun::SimulatorSetup &setup, int cameraCount)
+{
+    setup.clear_camera_setup();
+    const int columns = std::ceil(std::sqrt(cameraCount));
+    const int rows = (cameraCount + columns - 1) / columns;
+    const float width = setup.geometry().field_width();
+    const float height = setup.geometry().field_height();
+    for (int i = 0; i < cameraCount; i++) {
+        const float x = width * ((i % columns) + 0.5f) / columns - width / 2;
+        const float y = height * ((i / columns) + 0.5f) / rows - height / 2;
+        setup.add_camera_setup()->CopyFrom(createDefaultCamera(i, x, y, 4.0f));
+    }
+}
+
+static void addTeam(robot::Team *team)
+{
+    for (int i = 0; i < ROBOTS_PER_TEAM; i++) {
+        robot::Specs *specs = team->add_robot();
+        robotSetDefault(specs);
+        specs->set_id(i);
+    }
+}
+
+static SSLSimRobotControl createControl(Behaviour behaviour)
+{
+    SSLSimRobotControl control{new sslsim::RobotControl};
+    for (int i = 0; i < ROBOTS_PER_TEAM; i++) {
+        sslsim::RobotCommand *command = control->add_robot_commands();
+        command->set_id(i);
+        // drive in circles
+        auto *velocity = command->mutable_move_command()->mutable_local_velocity();
+        velocity->set_forward(0.5);
+        velocity->set_left(0);
+        velocity->set_angular(1);
+        command->set_dribbler_speed(behaviour == Behaviour::DRIBBLE ? 1000 : 0);
+        if (behaviour == Behaviour::CHIP_STORM) {
+            command->set_kick_speed(3);
+            command->set_kick_angle(45);
+        }
+    }
+    return control;
+}
+
+// places a blue robot at a fixed position with the ball in front of its dribbler
+static Command placeBallAtRobot(int id)
+{
+    const float x = -4000 + 800 * id;
+    const float y = 1000;
+
+    Command command(new amun::Command);
+    auto *sslControl = command->mutable_simulator()->mutable_ssl_control();
+    auto *robot = sslControl->add_teleport_robot();
+    robot->mutable_id()->set_id(id);
+    robot->mutable_id()->set_team(gameController::Team::BLUE);
+    robot->set_x(x);
+    robot->set_y(y);
+    robot->set_orientation(0);
+    robot->set_v_x(0);
+    robot->set_v_y(0);
+    robot->set_v_angular(0);
+
+    auto *ball = sslControl->mutable_teleport_ball();
+    ball->set_x(x + 90);
+    ball->set_y(y);
+    ball->set_z(0);
+    ball->set_vx(0);
+    ball->set_vy(0);
+    ball->set_vz(0);
+    return command;
+}
+
+// places both teams on a tight grid in and around the left defense area, together with the ball
+static Command crowdDefenseArea()
+{
+    Command command(new amun::Command);
+    auto *sslControl = command->mutable_simulator()->mutable_ssl_control();
+    for (int i = 0; i < 2 * ROBOTS_PER_TEAM; i++) {
+        const bool isBlue = i < ROBOTS_PER_TEAM;
+        const int index = i % ROBOTS_PER_TEAM;
+        auto *robot = sslControl->add_teleport_robot();
+        robot->mutable_id()->set_id(index);
+        robot->mutable_id()->set_team(isBlue ? gameController::Team::BLUE : gameController::Team::YELLOW);
+        robot->set_x(-4300 + 250 * (index % 2 + (isBlue ? 0 : 2)));
+        robot->set_y(-1250 + 250 * (index / 2));
+        robot->set_orientation(isBlue ? 0 : M_PI);
+        robot->set_v_x(0);
+        robot->set_v_y(0);
+        robot->set_v_angular(0);
+    }
+
+    auto *ball = sslControl->mutable_teleport_ball();
+    ball->set_x(-3925);
+    ball->set_y(0);
+    ball->set_z(0);
+    ball->set_vx(0);
+    ball->set_vy(0);
+    ball->set_vz(0);
+    return command;
+}
+
+static QJsonObject runScenario(const Scenario &scenario, double duration, const amun::SimulatorSetup &baseSetup)
+{
+    amun::SimulatorSetup setup = baseSetup;
+    if (scenario.cameraCount > 0) {
+        setCameraGrid(setup, scenario.cameraCount);
+    }
+
+    Timer timer;
+    timer.setScaling(0);
+    timer.setTime(1e9, 0);
+    Simulator sim(&timer, setup, true);
+    sim.seedPRGN(42);
+
+    Command command(new amun::Command);
+    command->mutable_simulator()->set_enable(true);
+    command->mutable_transceiver()->set_charge(true);
+    addTeam(command->mutable_set_team_blue());
+    addTeam(command->mutable_set_team_yellow());
+    sim.handleCommand(command);
+    if (scenario.behaviour == Behaviour::CROWD) {
+        sim.handleCommand(crowdDefenseArea());
+    }
+
+    // every robot gets a command at 100 Hz, just like in a real game
+    const SSLSimRobotControl control = createControl(scenario.behaviour);
+    // ball placements per second
+    const int placementRate = scenario.behaviour == Behaviour::CHIP_STORM ? 10 : 2;
+    int tick = 0;
+    const auto callback = [&]() {
+        if (scenario.behaviour != Behaviour::IDLE) {
+            sim.handleRadioCommands(control, true, timer.currentTime());
+            sim.handleRadioCommands(control, false, timer.currentTime());
+            if (scenario.behaviour != Behaviour::CROWD && tick % (100 / placementRate) == 0) {
+                sim.handleCommand(placeBallAtRobot((tick / (100 / placementRate)) % ROBOTS_PER_TEAM));
+            }
+        }
+        tick++;
+    };
+
+    sim.resetPhaseTimings();
+    const qint64 startTime = Timer::systemTime();
+    FastSimulator::goDeltaCallback(&sim, &timer, duration * 1E9, callback);
+    const double wallTime = (Timer::systemTime() - startTime) * 1E-9;
+
+    const PhaseTimings &timings = sim.phaseTimings();
+    QJsonObject phases;
+    phases["total"] = timings.total * 1E-6;
+    phases["radio_commands"] = timings.radioCommands * 1E-6;
+    phases["error_aggregation"] = timings.errorAggregation * 1E-6;
+    phases["physics"] = timings.physics * 1E-6;
+    phases["vision_packet"] = timings.visionPacket * 1E-6;
+    phases["serialization"] = timings.serialization * 1E-6;
+
+    QJsonObject result;
+    result["scenario"] = scenario.name;
+    result["tier"] = QString::fromStdString(amun::SimulatorSetup::PerformanceTier_Name(setup.performance_tier())).toLower();
+    result["broadphase"] = QString::fromStdString(amun::SimulatorSetup::Broadphase_Name(setup.broadphase())).toLower();
+    result["robots"] = 2 * ROBOTS_PER_TEAM;
+    result["cameras"] = setup.camera_setup_size();
+    result["sim_seconds"] = duration;
+    result["wall_seconds"] = wallTime;
+    result["realtime_factor"] = wallTime > 0 ? duration / wallTime : 0.;
+    result["process_calls"] = timings.processCalls;
+    // all phase times are in milliseconds
+    result["phases_ms"] = phases;
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("Simulator-Bench");
+    app.setOrganizationName("ER-Force");
+
+    std::setlocale(LC_NUMERIC, "C");
+
+    QStringList scenarioNames;
+    for (const Scenario &scenario : SCENARIOS) {
+        scenarioNames.append(scenario.name);
+    }
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Simulator throughput benchmark");
+    parser.addHelpOption();
+
+    QCommandLineOption durationOption({"d", "duration"}, "Simulated seconds per scenario", "seconds", "10");
+    parser.addOption(durationOption);
+    QCommandLineOption scenarioOption({"s", "scenario"}, "Scenario to run, can be given multiple times (" + scenarioNames.join(", ") + ")", "name");
+    parser.addOption(scenarioOption);
+    QCommandLineOption outputOption({"o", "output"}, "Write the JSON results to this file instead of stdout", "file");
+    parser.addOption(outputOption);
+    QCommandLineOption tierOption({"t", "tier"}, "Simulator performance tier (exact, fast, kinematic)", "tier", "exact");
+    parser.addOption(tierOption);
+    QCommandLineOption broadphaseOption({"b", "broadphase"}, "Bullet broadphase, can be given multiple times to compare them (dynamic_aabb_tree, sweep_and_prune)", "broadphase", "dynamic_aabb_tree");
+    parser.addOption(broadphaseOption);
+
+    parser.process(app);
+
+    bool ok = false;
+    const double duration = parser.value(durationOption).toDouble(&ok);
+    if (!ok || duration <= 0) {
+        std::cerr << "Invalid duration" << std::endl;
+        return 1;
+    }
+
+    amun::SimulatorSetup setup;
+    loadConfiguration("simulator/2020", &setup, false);
+    amun::SimulatorSetup::PerformanceTier tier;
+    if (!amun::SimulatorSetup::PerformanceTier_Parse(parser.value(tierOption).toUpper().toStdString(), &tier)) {
+        std::cerr << "Unknown tier " << parser.value(tierOption).toStdString() << std::endl;
+        return 1;
+    }
+    setup.set_performance_tier(tier);
+    QList<amun::SimulatorSetup::Broadphase> broadphases;
+    for (const QString &name : parser.values(broadphaseOption)) {
+        amun::SimulatorSetup::Broadphase broadphase;
+        if (!amun::SimulatorSetup::Broadphase_Parse(name.toUpper().toStdString(), &broadphase)) {
+            std::cerr << "Unknown broadphase " << name.toStdString() << std::endl;
+            return 1;
+        }
+        broadphases.append(broadphase);
+    }
+
+    const QStringList selected = parser.isSet(scenarioOption) ? parser.values(scenarioOption) : scenarioNames;
+    QJsonArray results;
+    for (const QString &name : selected) {
+        auto scenario = std::find_if(SCENARIOS.begin(), SCENARIOS.end(), [&name](const Scenario &s) { return s.name == name; });
+        if (scenario == SCENARIOS.end()) {
+            std::cerr << "Unknown scenario " << name.toStdString() << std::endl;
+            return 1;
+        }
+        // the broadphases run directly after each other, so they see the same machine load
+        for (amun::SimulatorSetup::Broadphase broadphase : broadphases) {
+            setup.set_broadphase(broadphase);
+            results.append(runScenario(*scenario, duration, setup));
+        }
+    }
+
+    const QByteArray json = QJsonDocument(results).toJson();
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            std::cerr << "Could not open " << file.fileName().toStdString() << std::endl;
+            return 1;
+        }
+        file.write(json);
+    } else {
+        std::cout << json.constData();
+    }
+    return 0;
+}
@@ -24,6 +24,12 @@
 #include <QColor>
 #include <iostream>
 
+#ifdef Q_OS_LINUX
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <cstring>
+#endif
+
 using namespace std;
 
 RoboCupSSLServer::RoboCupSSLServer(QObject *parent, const quint16 &port, const string &net_address) :
@@ -69,3 +75,51 @@ bool RoboCupSSLServer::send(const QByteArray& datagram) {
     return true;
 }
 
+bool RoboCupSSLServer::send(const QList<QByteArray>& datagrams) {
+#ifdef Q_OS_LINUX
+    const int fd = _socket->socketDescriptor();
+    // the socket is only created by the first write, use the regular path until then
+    if (fd != -1 && _net_address->protocol() == QAbstractSocket::IPv4Protocol) {
+        sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(_port);
+        address.sin_addr.s_addr = htonl(_net_address->toIPv4Address());
+
+        mutex.lock();
+        if (_messages.size() < (std::size_t)datagrams.size()) {
+            _messages.resize(datagrams.size());
+            _buffers.resize(datagrams.size());
+        }
+        for (int i = 0; i < datagrams.size(); i++) {
+            _buffers[i].iov_base = const_cast<char*>(datagrams[i].constData());
+            _buffers[i].iov_len = datagrams[i].size();
+            std::memset(&_messages[i], 0, sizeof(mmsghdr));
+            _messages[i].msg_hdr.msg_name = &address;
+            _messages[i].msg_hdr.msg_namelen = sizeof(address);
+            _messages[i].msg_hdr.msg_iov = &_buffers[i];
+            _messages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int sent = 0;
+        while (sent < datagrams.size()) {
+            const int result = sendmmsg(fd, _messages.data() + sent, datagrams.size() - sent, 0);
+            if (result <= 0) {
+                break;
+            }
+            sent += result;
+        }
+        mutex.unlock();
+        if (sent != datagrams.size()) {
+            logStatus(QString("Sending UDP datagrams failed, only %1 of %2 were sent.").arg(sent).arg(datagrams.size()), QColor("red"));
+            return false;
+        }
+        return true;
+    }
+#endif
+    bool success = true;
+    for (const QByteArray& datagram : datagrams) {
+        success &= send(datagram);
+    }
+    return success;
+}
@@ -22,8 +22,13 @@
 #ifndef ROBOCUP_SSL_SERVER_H
 #define ROBOCUP_SSL_SERVER_H
 #include <string>
+#include <QList>
 #include <QMutex>
 #include <QObject>
+#ifdef Q_OS_LINUX
+#include <sys/socket.h>
+#include <vector>
+#endif
 using namespace std;
 
 class QUdpSocket;
@@ -42,6 +47,8 @@ public:
     ~RoboCupSSLServer();
 
     bool send(const QByteArray& datagram);
+    // sends all datagrams at once if supported by the platform
+    bool send(const QList<QByteArray>& datagrams);
     void change_port(const quint16 &port);
     void change_address(const string & net_address);
 
@@ -50,6 +57,11 @@ protected:
     QMutex mutex;
     quint16 _port;
     QHostAddress * _net_address;
+#ifdef Q_OS_LINUX
+    // headers for sending several datagrams at once, only grow and are reused for every send
+    std::vector<mmsghdr> _messages;
+    std::vector<iovec> _buffers;
+#endif
 };
 
 #endif
@@ -0,0 +1,89 @@
+/***************************************************************************
+ *   Copyright 2021                                                        *
+ *   Robotics Erlangen e.V.                                                *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "gtest/gtest.h"
+#include "simulator/batchsimulator.h"
+#include "core/configuration.h"
+#include "protobuf/command.h"
+#include "protobuf/robot.h"
+#include "protobuf/world.pb.h"
+
+using camun::simulator::BatchSimulator;
+
+static void addRobots(BatchSimulator &batch, int world, int count)
+{
+    Command c{new amun::Command};
+    for (int i = 0; i < count; i++) {
+        robot::Specs *specs = c->mutable_set_team_blue()->add_robot();
+        robotSetDefault(specs);
+        specs->set_id(i);
+    }
+    batch.handleCommand(world, c);
+}
+
+TEST(BatchSimulator, IndependentWorlds) {
+    amun::SimulatorSetup setup;
+    loadConfiguration("simulator/2020", &setup, false);
+
+    BatchSimulator batch(2);
+    for (int i = 0; i < 4; i++) {
+        ASSERT_EQ(batch.addWorld(setup, 42), i);
+        // only the last world gets robots
+        if (i == 3) {
+            addRobots(batch, i, 3);
+        }
+    }
+    ASSERT_EQ(batch.worldCount(), 4);
+
+    batch.step(1e9); // one second
+
+    for (int i = 0; i < batch.worldCount(); i++) {
+        const BatchSimulator::WorldOutput output = batch.takeOutput(i);
+        const int expPackets = 60 * 2; // 60 Hz * 2 cameras
+        ASSERT_LE(output.visionPackets.size(), expPackets * 1.2);
+        ASSERT_GE(output.visionPackets.size(), expPackets * 0.8);
+        ASSERT_GT(output.simulatorStates.size(), 0);
+
+        world::SimulatorState state;
+        ASSERT_TRUE(state.ParseFromArray(output.simulatorStates.last().data(), output.simulatorStates.last().size()));
+        ASSERT_EQ(state.blue_robots_size(), i == 3 ? 3 : 0);
+
+        // output is cleared after taking it
+        ASSERT_EQ(batch.takeOutput(i).visionPackets.size(), 0);
+    }
+}
+
+TEST(BatchSimulator, Callback) {
+    amun::SimulatorSetup setup;
+    loadConfiguration("simulator/2020", &setup, false);
+
+    BatchSimulator batch;
+    batch.addWorld(setup, 1);
+    batch.addWorld(setup, 2);
+
+    std::vector<int> calls(2, 0);
+    batch.step(1e8, [&calls](int world) {
+        calls[world]++;
+    });
+    // initial call + every 10 ms
+    ASSERT_EQ(calls[0], 11);
+    ASSERT_EQ(calls[1], 11);
+    ASSERT_EQ(batch.currentTime(0), batch.currentTime(1));
+}
@@ -0,0 +1,107 @@
+/***************************************************************************
+ *   Copyright 2021                                                        *
+ *   Robotics Erlangen e.V.                                                *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "gtest/gtest.h"
+#include "simulator/robottable.h"
+
+#include <vector>
+
+using camun::simulator::RobotTable;
+using camun::simulator::SimRobot;
+
+// the table never dereferences the robots, distinct addresses are enough
+static SimRobot *fakeRobot(unsigned id)
+{
+    static char storage[RobotTable::CAPACITY];
+    return reinterpret_cast<SimRobot *>(&storage[id]);
+}
+
+static std::vector<unsigned> ids(const RobotTable &table)
+{
+    std::vector<unsigned> result;
+    for (const auto &entry : table) {
+        result.push_back(entry.id);
+    }
+    return result;
+}
+
+TEST(RobotTable, SortedInsert) {
+    RobotTable table;
+    ASSERT_TRUE(table.isEmpty());
+    for (unsigned id : {7, 2, 15, 0, 9}) {
+        ASSERT_TRUE(table.insert(id, fakeRobot(id), id + 100));
+    }
+    ASSERT_EQ(table.size(), 5u);
+    ASSERT_EQ(ids(table), std::vector<unsigned>({0, 2, 7, 9, 15}));
+    for (unsigned id : {7, 2, 15, 0, 9}) {
+        ASSERT_TRUE(table.contains(id));
+        ASSERT_EQ(table.robot(id), fakeRobot(id));
+        ASSERT_EQ(table.find(id)->generation, id + 100);
+    }
+    ASSERT_FALSE(table.contains(1));
+    ASSERT_EQ(table.robot(1), nullptr);
+    ASSERT_EQ(table.find(1), nullptr);
+}
+
+TEST(RobotTable, Take) {
+    RobotTable table;
+    for (unsigned id : {3, 1, 4, 5}) {
+        table.insert(id, fakeRobot(id), 0);
+    }
+    ASSERT_EQ(table.take(4), fakeRobot(4));
+    ASSERT_EQ(ids(table), std::vector<unsigned>({1, 3, 5}));
+    ASSERT_FALSE(table.contains(4));
+    // the remaining robots are still found after shifting the entries
+    ASSERT_EQ(table.robot(5), fakeRobot(5));
+    ASSERT_EQ(table.take(4), nullptr);
+
+    ASSERT_EQ(table.take(1), fakeRobot(1));
+    ASSERT_EQ(ids(table), std::vector<unsigned>({3, 5}));
+    ASSERT_EQ(table.robot(3), fakeRobot(3));
+
+    // the id can be used again
+    ASSERT_TRUE(table.insert(4, fakeRobot(4), 0));
+    ASSERT_EQ(ids(table), std::vector<unsigned>({3, 4, 5}));
+
+    table.clear();
+    ASSERT_TRUE(table.isEmpty());
+    ASSERT_FALSE(table.contains(3));
+}
+
+TEST(RobotTable, DuplicateId) {
+    RobotTable table;
+    ASSERT_TRUE(table.insert(6, fakeRobot(6), 1));
+    ASSERT_FALSE(table.insert(6, fakeRobot(7), 2));
+    ASSERT_EQ(table.size(), 1u);
+    ASSERT_EQ(table.robot(6), fakeRobot(6));
+    ASSERT_EQ(table.find(6)->generation, 1u);
+}
+
+TEST(RobotTable, OutOfRangeId) {
+    RobotTable table;
+    ASSERT_TRUE(RobotTable::isValidId(RobotTable::CAPACITY - 1));
+    ASSERT_FALSE(RobotTable::isValidId(RobotTable::CAPACITY));
+    ASSERT_FALSE(table.insert(RobotTable::CAPACITY, fakeRobot(0), 0));
+    ASSERT_FALSE(table.insert(1000, fakeRobot(0), 0));
+    ASSERT_TRUE(table.isEmpty());
+    ASSERT_FALSE(table.contains(RobotTable::CAPACITY));
+    ASSERT_EQ(table.robot(1000), nullptr);
+    ASSERT_EQ(table.take(1000), nullptr);
+}
@@ -29,10 +29,13 @@
 #include "protobuf/status.h"
 #include "protobuf/ssl_wrapper.pb.h"
 
+#include <QFile>
 #include <QObject>
 #include <QQuaternion>
+#include <QTemporaryDir>
 #include <functional>
 #include <cmath>
+#include <cstring>
 
 class SimTester : public QObject {
     Q_OBJECT
@@ -167,6 +170,21 @@ TEST_F(FastSimulatorTest, OriginString) {
     FastSimulator::goDelta(s, &t, 5e8); // 500 millisecond
 }
 
+TEST_F(FastSimulatorTest, VisionDelay) {
+    s->disconnect(s, &Simulator::sendRealData, &test, &SimTester::handleSimulatorTruthRaw);
+    int packets = 0;
+    // the packets are received at their scheduled time, never before the simulation reached it
+    s->connect(s, &Simulator::gotPacket, [this, &packets] (const QByteArray &data, qint64 time, QString) {
+        SSL_WrapperPacket wrapper;
+        ASSERT_TRUE(wrapper.ParseFromArray(data.data(), data.size()));
+        ASSERT_LE(time, t.currentTime());
+        ASSERT_NEAR(wrapper.detection().t_sent() * 1E9, time, 1000);
+        packets++;
+    });
+    FastSimulator::goDelta(s, &t, 5e8); // 500 millisecond
+    ASSERT_GT(packets, 0);
+}
+
 TEST_F(FastSimulatorTest, NoRobots) {
     s->disconnect(s, &Simulator::sendRealData, &test, &SimTester::handleSimulatorTruthRaw);
     s->connect(s, &Simulator::gotPacket, &test, &SimTester::handlePacket);
@@ -598,6 +616,42 @@ TEST_F(FastSimulatorTest, UnaffectedRobotsByCommands) {
     FastSimulator::goDeltaCallback(s, &t, 2e9, callback); // 2 seconds
 }
 
+TEST_F(FastSimulatorTest, RadioResponses) {
+    loadRobots(2, 2);
+    SSLSimRobotControl control{new sslsim::RobotControl};
+    for (int id : {0, 1}) {
+        auto *cmd = control->add_robot_commands();
+        cmd->set_id(id);
+        auto *localVel = cmd->mutable_move_command()->mutable_local_velocity();
+        localVel->set_forward(0.5);
+        localVel->set_left(0);
+        localVel->set_angular(0);
+    }
+    auto callback = [&control, this]() {
+        emit this->test.sendSSLRadioCommand(control, true, 0);
+        emit this->test.sendSSLRadioCommand(control, false, 0);
+    };
+    t.connect(&test, &SimTester::sendSSLRadioCommand, s, &Simulator::handleRadioCommands);
+
+    std::vector<QList<robot::RadioResponse>> received;
+    s->connect(s, &Simulator::sendRadioResponses, [&received] (const QList<robot::RadioResponse> &responses) {
+        if (!responses.isEmpty()) {
+            received.push_back(responses);
+        }
+    });
+    FastSimulator::goDeltaCallback(s, &t, 1e8, callback); // 100 milliseconds
+
+    // one response per robot and command, the lists of earlier ticks keep their content
+    // although the simulator reuses its response buffer
+    ASSERT_GT(received.size(), 2u);
+    for (std::size_t i = 0; i < received.size(); i++) {
+        ASSERT_EQ(received[i].size(), 4);
+        if (i > 0) {
+            ASSERT_GT(received[i][0].time(), received[i - 1][0].time());
+        }
+    }
+}
+
 TEST_F(FastSimulatorTest, TeleportRobot) {
     loadRobots(1, 0);
 
@@ -818,3 +872,369 @@ TEST_F(FastSimulatorTest, CameraOverlap) {
     checkCameras(Vector(2, -0.51), {2});
     checkCameras(Vector(2, -0.49), {0, 2});
 }
+
+TEST_F(FastSimulatorTest, SnapshotRestore) {
+    loadRobots(2, 2);
+
+    Command command(new amun::Command);
+    auto teleport = command->mutable_simulator()->mutable_ssl_control()->mutable_teleport_ball();
+    teleport->set_x(0);
+    teleport->set_y(0);
+    teleport->set_vx(2);
+    teleport->set_vy(1);
+    emit this->test.sendCommand(command);
+    FastSimulator::goDelta(s, &t, 2e8);
+
+    const auto snapshot = s->createSnapshot();
+    std::string lastTruth;
+    test.handleSimulatorTruth = [&lastTruth] (auto truth) {
+        lastTruth = truth.SerializeAsString();
+    };
+
+    s->restoreSnapshot(*snapshot);
+    FastSimulator::goDelta(s, &t, 3e8);
+    const std::string firstRun = lastTruth;
+    ASSERT_FALSE(firstRun.empty());
+
+    s->restoreSnapshot(*snapshot);
+    FastSimulator::goDelta(s, &t, 3e8);
+    ASSERT_EQ(firstRun, lastTruth);
+}
+
+TEST_F(FastSimulatorTest, Fork) {
+    loadRobots(3, 1);
+    FastSimulator::goDelta(s, &t, 1e8);
+
+    Timer forkTimer;
+    forkTimer.setScaling(0);
+    forkTimer.setTime(1234, 0);
+    std::unique_ptr<Simulator> fork = s->fork(&forkTimer);
+
+    int packets = 0;
+    fork->connect(fork.get(), &Simulator::sendRealData, [&packets] (const QByteArray &data) {
+        world::SimulatorState truth;
+        ASSERT_TRUE(truth.ParseFromArray(data.data(), data.size()));
+        ASSERT_EQ(truth.blue_robots_size(), 3);
+        ASSERT_EQ(truth.yellow_robots_size(), 1);
+        packets++;
+    });
+    FastSimulator::goDelta(fork.get(), &forkTimer, 1e8);
+    ASSERT_GT(packets, 0);
+}
+
+TEST_F(FastSimulatorTest, AdaptiveStepping) {
+    loadRobots(1, 0);
+
+    // let the ball roll through the empty half of the field
+    Command command(new amun::Command);
+    auto teleport = command->mutable_simulator()->mutable_ssl_control()->mutable_teleport_ball();
+    coordinates::toVision(Vector(-1, -2), *teleport);
+    coordinates::toVisionVelocity(Vector(0.5, 1.5), *teleport);
+    emit this->test.sendCommand(command);
+    FastSimulator::goDelta(s, &t, 5e8);
+
+    Timer adaptiveTimer;
+    adaptiveTimer.setScaling(0);
+    adaptiveTimer.setTime(1234, 0);
+    std::unique_ptr<Simulator> adaptive = s->fork(&adaptiveTimer);
+    adaptive->setAdaptiveStepping(true);
+
+    world::SimulatorState exactState, adaptiveState;
+    test.handleSimulatorTruth = [&exactState] (auto truth) {
+        exactState = truth;
+    };
+    adaptive->connect(adaptive.get(), &Simulator::sendRealData, [&adaptiveState] (const QByteArray &data) {
+        adaptiveState.ParseFromArray(data.data(), data.size());
+    });
+    FastSimulator::goDelta(s, &t, 2e9);
+    FastSimulator::goDelta(adaptive.get(), &adaptiveTimer, 2e9);
+
+    ASSERT_TRUE(exactState.has_ball());
+    ASSERT_TRUE(adaptiveState.has_ball());
+    const Vector exactBall(exactState.ball().p_x(), exactState.ball().p_y());
+    const Vector adaptiveBall(adaptiveState.ball().p_x(), adaptiveState.ball().p_y());
+    ASSERT_LE(exactBall.distance(adaptiveBall), 0.1f);
+    ASSERT_EQ(adaptiveState.blue_robots_size(), 1);
+    ASSERT_LE(std::abs(exactState.blue_robots(0).p_x() - adaptiveState.blue_robots(0).p_x()), 0.01f);
+    ASSERT_LE(std::abs(exactState.blue_robots(0).p_y() - adaptiveState.blue_robots(0).p_y()), 0.01f);
+}
+
+TEST_F(FastSimulatorTest, KinematicTier) {
+    amun::SimulatorSetup setup;
+    loadConfiguration("simulator/2020", &setup, false);
+    setup.set_performance_tier(amun::SimulatorSetup::KINEMATIC);
+    createSimulator(setup);
+    loadRobots(1, 0);
+
+    world::SimulatorState state;
+    test.handleSimulatorTruth = [&state] (auto truth) {
+        state = truth;
+    };
+    FastSimulator::goDelta(s, &t, 5e8);
+    ASSERT_EQ(state.blue_robots_size(), 1);
+    const float startZ = state.blue_robots(0).p_z();
+
+    SSLSimRobotControl control{new sslsim::RobotControl};
+    auto* cmd = control->add_robot_commands();
+    cmd->set_id(0);
+    auto* localVel = cmd->mutable_move_command()->mutable_local_velocity();
+    localVel->set_forward(1);
+    localVel->set_left(0);
+    localVel->set_angular(0);
+
+    t.connect(&test, &SimTester::sendSSLRadioCommand, s, &Simulator::handleRadioCommands);
+    auto callback = [&control, this]() {
+        emit this->test.sendSSLRadioCommand(control, true, 0);
+    };
+    FastSimulator::goDeltaCallback(s, &t, 1e9, callback);
+
+    // the robot follows the command within its acceleration limits and stays on the ground
+    ASSERT_EQ(state.blue_robots_size(), 1);
+    const auto &robot = state.blue_robots(0);
+    ASSERT_LE(std::abs(std::sqrt(robot.v_x() * robot.v_x() + robot.v_y() * robot.v_y()) - 1), 5e-2);
+    ASSERT_LE(std::abs(robot.p_z() - startZ), 1e-2);
+}
+
+TEST_F(FastSimulatorTest, GroundTruthExport) {
+    loadRobots(2, 1);
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString filename = dir.filePath("truth.bin");
+
+    Command command(new amun::Command);
+    auto* exportConfig = command->mutable_simulator()->mutable_ground_truth_export();
+    exportConfig->set_filename(filename.toStdString());
+    exportConfig->set_decimation(2);
+    exportConfig->add_fields(amun::GroundTruthExport::POSITION);
+    emit this->test.sendCommand(command);
+
+    int frames = 0;
+    test.handleSimulatorTruth = [&frames] (auto truth) {
+        ASSERT_EQ(truth.blue_robots_size(), 2);
+        frames++;
+    };
+    FastSimulator::goDelta(s, &t, 1e9);
+
+    // an empty export config closes the file
+    Command stop(new amun::Command);
+    stop->mutable_simulator()->mutable_ground_truth_export();
+    emit this->test.sendCommand(stop);
+
+    QFile file(filename);
+    ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+    const QByteArray data = file.readAll();
+    ASSERT_GE(data.size(), 12);
+    ASSERT_EQ(data.left(4), QByteArray("ERGT"));
+    quint32 fieldMask;
+    memcpy(&fieldMask, data.constData() + 8, sizeof(fieldMask));
+    ASSERT_EQ(fieldMask, 1u);
+
+    // one row for the ball and every robot, only the position columns are present
+    int offset = 12;
+    int rows = 0;
+    while (offset < data.size()) {
+        quint32 blockRows;
+        memcpy(&blockRows, data.constData() + offset, sizeof(blockRows));
+        offset += sizeof(blockRows);
+        if (rows == 0) {
+            const char *kind = data.constData() + offset + blockRows * sizeof(qint64);
+            ASSERT_EQ(kind[0], 0);
+            ASSERT_EQ(kind[1], 1);
+            ASSERT_EQ(kind[2], 1);
+            ASSERT_EQ(kind[3], 2);
+        }
+        offset += blockRows * (sizeof(qint64) + 2 + 3 * sizeof(float));
+        rows += blockRows;
+    }
+    ASSERT_EQ(offset, data.size());
+    ASSERT_EQ(rows % 4, 0);
+    ASSERT_LE(std::abs(rows / 4 - frames / 2), 3);
+}
+
+TEST_F(FastSimulatorTest, SweepAndPruneBroadphase) {
+    amun::SimulatorSetup setup;
+    loadConfiguration("simulator/2020", &setup, false);
+    setup.set_broadphase(amun::SimulatorSetup::SWEEP_AND_PRUNE);
+    Timer sapTimer;
+    sapTimer.setScaling(0);
+    sapTimer.setTime(1234, 0);
+    Simulator sap(&sapTimer, setup, true);
+    sap.seedPRGN(14986);
+
+    // the ball bounces off the field boundary
+    Command command(new amun::Command);
+    command->mutable_simulator()->set_enable(true);
+    auto teleport = command->mutable_simulator()->mutable_ssl_control()->mutable_teleport_ball();
+    coordinates::toVision(Vector(2, 0), *teleport);
+    coordinates::toVisionVelocity(Vector(0, 6), *teleport);
+    emit this->test.sendCommand(command);
+    sap.handleCommand(command);
+
+    world::SimulatorState exactState, sapState;
+    test.handleSimulatorTruth = [&exactState] (auto truth) {
+        exactState = truth;
+    };
+    sap.connect(&sap, &Simulator::sendRealData, [&sapState] (const QByteArray &data) {
+        sapState.ParseFromArray(data.data(), data.size());
+    });
+    FastSimulator::goDelta(s, &t, 3e9);
+    FastSimulator::goDelta(&sap, &sapTimer, 3e9);
+
+    ASSERT_TRUE(exactState.has_ball());
+    ASSERT_TRUE(sapState.has_ball());
+    // the ball must have hit the boundary and rolled back
+    ASSERT_LT(exactState.ball().v_y(), 0);
+    ASSERT_LE(std::abs(exactState.ball().p_x() - sapState.ball().p_x()), 1e-2);
+    ASSERT_LE(std::abs(exactState.ball().p_y() - sapState.ball().p_y()), 1e-2);
+}
+
+TEST_F(FastSimulatorTest, IndependentNoiseStreams) {
+    amun::SimulatorSetup setup;
+    loadConfiguration("simulator/2020", &setup, false);
+    Timer otherTimer;
+    otherTimer.setScaling(0);
+    otherTimer.setTime(1234, 0);
+    Simulator other(&otherTimer, setup, true);
+    other.seedPRGN(14986);
+
+    // both simulators get a blue robot, only the other one an additional yellow robot
+    test.connect(&test, &SimTester::sendCommand, &other, &Simulator::handleCommand);
+    Command command(new amun::Command);
+    command->mutable_simulator()->set_enable(true);
+    command->mutable_simulator()->mutable_realism_config()->set_stddev_robot_p(0.01f);
+    command->mutable_simulator()->mutable_realism_config()->set_stddev_robot_phi(0.01f);
+    command->mutable_simulator()->mutable_realism_config()->set_robot_command_loss(0.3f);
+    command->mutable_simulator()->mutable_realism_config()->set_robot_response_loss(0.3f);
+    command->mutable_simulator()->mutable_realism_config()->set_dribbler_ball_detections(10);
+    emit this->test.sendCommand(command);
+    loadRobots(1, 1);
+    test.disconnect(&test, &SimTester::sendCommand, &other, &Simulator::handleCommand);
+    loadRobots(1, 0);
+
+    auto collect = [] (std::vector<float> &values) {
+        return [&values] (const QByteArray &data, qint64, QString) {
+            SSL_WrapperPacket wrapper;
+            ASSERT_TRUE(wrapper.ParseFromArray(data.data(), data.size()));
+            for (const auto &robot : wrapper.detection().robots_blue()) {
+                values.push_back(robot.x());
+                values.push_back(robot.y());
+                values.push_back(robot.orientation());
+            }
+        };
+    };
+    auto collectResponses = [] (std::vector<qint64> &times) {
+        return [&times] (const QList<robot::RadioResponse> &responses) {
+            for (const auto &response : responses) {
+                if (response.is_blue()) {
+                    times.push_back(response.time());
+                }
+            }
+        };
+    };
+    std::vector<float> values, otherValues;
+    std::vector<qint64> responseTimes, otherResponseTimes;
+    s->connect(s, &Simulator::gotPacket, collect(values));
+    other.connect(&other, &Simulator::gotPacket, collect(otherValues));
+    s->connect(s, &Simulator::sendRadioResponses, collectResponses(responseTimes));
+    other.connect(&other, &Simulator::sendRadioResponses, collectResponses(otherResponseTimes));
+
+    // both robots get commands, the lost commands and responses are drawn per robot
+    SSLSimRobotControl control{new sslsim::RobotControl};
+    auto *cmd = control->add_robot_commands();
+    cmd->set_id(0);
+    auto *localVel = cmd->mutable_move_command()->mutable_local_velocity();
+    localVel->set_forward(0.5);
+    localVel->set_left(0);
+    localVel->set_angular(1);
+    auto sendCommands = [&control] (Simulator *sim) {
+        return [&control, sim] () {
+            sim->handleRadioCommands(control, true, 0);
+            sim->handleRadioCommands(control, false, 0);
+        };
+    };
+    FastSimulator::goDeltaCallback(s, &t, 5e8, sendCommands(s));
+    FastSimulator::goDeltaCallback(&other, &otherTimer, 5e8, sendCommands(&other));
+
+    // the noise of the blue robot must not depend on the other robots
+    ASSERT_GT(values.size(), 0u);
+    ASSERT_EQ(values, otherValues);
+    ASSERT_GT(responseTimes.size(), 0u);
+    ASSERT_EQ(responseTimes, otherResponseTimes);
+}
+
+TEST_F(FastSimulatorTest, ReloadRobots) {
+    // reloading a team reuses the previous robots, they have to be reset completely
+    world::SimulatorState lastTruth;
+    test.handleSimulatorTruth = [&lastTruth] (auto truth) {
+        lastTruth = truth;
+    };
+
+    loadRobots(2, 2);
+    FastSimulator::goDelta(s, &t, 1e8);
+    const world::SimulatorState initial = lastTruth;
+    ASSERT_EQ(initial.blue_robots_size(), 2);
+
+    Command command(new amun::Command);
+    auto teleport = command->mutable_simulator()->mutable_ssl_control()->add_teleport_robot();
+    teleport->mutable_id()->set_id(0);
+    teleport->mutable_id()->set_team(gameController::Team::BLUE);
+    coordinates::toVision(Vector(1, 1), *teleport);
+    teleport->set_v_x(1000);
+    teleport->set_v_y(0);
+    teleport->set_v_angular(2);
+    teleport->set_orientation(1);
+    emit this->test.sendCommand(command);
+    FastSimulator::goDelta(s, &t, 1e8);
+
+    loadRobots(2, 2);
+    FastSimulator::goDelta(s, &t, 1e8);
+    ASSERT_EQ(lastTruth.blue_robots_size(), 2);
+    ASSERT_EQ(lastTruth.yellow_robots_size(), 2);
+    for (int i = 0; i < 2; i++) {
+        const auto &before = initial.blue_robots(i);
+        const auto &after = lastTruth.blue_robots(i);
+        ASSERT_LE(std::abs(before.p_x() - after.p_x()), 1e-2);
+        ASSERT_LE(std::abs(before.p_y() - after.p_y()), 1e-2);
+        ASSERT_LE(std::abs(after.v_x()), 1e-2);
+        ASSERT_LE(std::abs(after.v_y()), 1e-2);
+        ASSERT_LE(std::abs(before.rotation().real() - after.rotation().real()), 1e-2);
+    }
+}
+
+TEST_F(FastSimulatorTest, ErrorAggregation) {
+    QList<SSLSimError> configErrors;
+    s->connect(s, &Simulator::sendSSLSimError, [&configErrors](const QList<SSLSimError> &errors, ErrorSource source) {
+        if (source == ErrorSource::CONFIG) {
+            configErrors.append(errors);
+        }
+    });
+
+    // creating a robot without specs fails, identical errors are only reported once
+    Command command(new amun::Command);
+    for (int i = 0; i < 3; i++) {
+        auto teleport = command->mutable_simulator()->mutable_ssl_control()->add_teleport_robot();
+        teleport->mutable_id()->set_id(5);
+        teleport->mutable_id()->set_team(gameController::Team::BLUE);
+        teleport->set_present(true);
+        coordinates::toVision(Vector(1, 1), *teleport);
+    }
+    emit this->test.sendCommand(command);
+    FastSimulator::goDelta(s, &t, 1e7);
+
+    ASSERT_EQ(configErrors.size(), 1);
+    ASSERT_EQ(configErrors[0]->code(), "CREATE_UNSPEC_ROBOT");
+    ASSERT_NE(configErrors[0]->message().find("repeated 3 times"), std::string::npos);
+    const SSLSimError firstReport = configErrors[0];
+
+    // the errors are only reported for the tick they occured in
+    configErrors.clear();
+    FastSimulator::goDelta(s, &t, 1e7);
+    ASSERT_EQ(configErrors.size(), 0);
+
+    // the same repetition is reported with the same message object instead of a new copy
+    emit this->test.sendCommand(command);
+    FastSimulator::goDelta(s, &t, 1e7);
+    ASSERT_EQ(configErrors.size(), 1);
+    ASSERT_EQ(configErrors[0].data(), firstReport.data());
+    ASSERT_EQ(configErrors[0]->message(), firstReport->message());
+}
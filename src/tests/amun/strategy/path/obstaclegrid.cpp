@@ -0,0 +1,107 @@
+/***************************************************************************
+ *   Copyright 2021                                                        *
+ *   Robotics Erlangen e.V.                                                *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "gtest/gtest.h"
+#include "core/rng.h"
+#include "path/obstaclegrid.h"
+#include "path/worldinformation.h"
+
+#include <algorithm>
+
+// the grid and the obstacle arrays must find the same obstacles and distances as checking every obstacle
+TEST(ObstacleGrid, MatchesLinearSearch) {
+    RNG rng(42);
+    WorldInformation world;
+    world.setRadius(0.09f);
+    world.setBoundary(-7, -5, 7, 5);
+    for (int i = 0;i<60;i++) {
+        const float x = rng.uniformFloat(-6, 6);
+        const float y = rng.uniformFloat(-4.5f, 4.5f);
+        switch (i % 4) {
+        case 0:
+            world.addCircle(x, y, rng.uniformFloat(0.05f, 0.5f), nullptr, 50);
+            break;
+        case 1:
+            world.addRect(x, y, x + rng.uniformFloat(0.1f, 2), y + rng.uniformFloat(0.1f, 2), nullptr, 50, 0.1f);
+            break;
+        case 2:
+            world.addLine(x, y, x + rng.uniformFloat(-3, 3), y + rng.uniformFloat(-3, 3), 0.05f, nullptr, 50);
+            break;
+        default:
+            world.addTriangle(x, y, x + 0.5f, y, x, y + 0.5f, 0.02f, nullptr, 50);
+            break;
+        }
+    }
+    // large obstacle covering most of the field
+    world.addRect(-6.5, -4.8, 6.5, -4.6, nullptr, 50, 0);
+    world.collectObstacles();
+
+    ObstacleGrid grid;
+    grid.build(world.obstacles());
+
+    for (int i = 0;i<500;i++) {
+        const Vector pos(rng.uniformFloat(-8, 8), rng.uniformFloat(-6, 6));
+
+        BoundingBox box(pos, pos + Vector(rng.uniformFloat(-2, 2), rng.uniformFloat(-2, 2)));
+        std::vector<const StaticObstacles::Obstacle*> expected, found;
+        for (const auto obstacle : world.obstacles()) {
+            if (obstacle->boundingBox().intersects(box)) {
+                expected.push_back(obstacle);
+            }
+        }
+        grid.visit(box, [&](const StaticObstacles::Obstacle *obstacle) {
+            found.push_back(obstacle);
+            return true;
+        });
+        std::sort(expected.begin(), expected.end());
+        std::sort(found.begin(), found.end());
+        ASSERT_EQ(expected, found);
+
+        float minDistance = std::numeric_limits<float>::max();
+        for (const auto obstacle : world.obstacles()) {
+            minDistance = std::min(minDistance, obstacle->distance(pos));
+        }
+        const float distance = world.minObstacleDistancePoint(pos, 0, true, false);
+        if (minDistance <= 0) {
+            ASSERT_LE(distance, 0);
+        } else {
+            ASSERT_EQ(distance, minDistance);
+        }
+        ASSERT_EQ(world.isInStaticObstacle(pos), world.isInStaticObstacle(world.obstacles(), pos));
+    }
+}
+
+TEST(ObstacleGrid, VisitStopsEarly) {
+    WorldInformation world;
+    world.setRadius(0);
+    for (int i = 0;i<10;i++) {
+        world.addCircle(i * 0.1f, 0, 1, nullptr, 50);
+    }
+    world.collectObstacles();
+
+    ObstacleGrid grid;
+    grid.build(world.obstacles());
+    int visited = 0;
+    grid.visit(BoundingBox(Vector(-1, -1), Vector(1, 1)), [&](const StaticObstacles::Obstacle *) {
+        visited++;
+        return visited < 3;
+    });
+    ASSERT_EQ(visited, 3);
+}
@@ -0,0 +1,70 @@
+/***************************************************************************
+ *   Copyright 2021                                                        *
+ *   Robotics Erlangen e.V.                                                *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "gtest/gtest.h"
+#include "core/rng.h"
+#include "path/standardsampler.h"
+#include "path/worldinformation.h"
+
+static TrajectoryInput constructInput(Vector s0, Vector s1) {
+    TrajectoryInput input;
+    input.v0 = Vector(0, 0);
+    input.v1 = Vector(0, 0);
+    input.distance = s1 - s0;
+    input.s0 = s0;
+    input.s1 = s1;
+    input.t0 = 0;
+    input.exponentialSlowDown = true;
+    input.maxSpeed = 3;
+    input.maxSpeedSquared = input.maxSpeed * input.maxSpeed;
+    input.acceleration = 3;
+    return input;
+}
+
+// the target lies straight behind an obstacle, only the samples leading around it may be chosen
+TEST(StandardSampler, PrecomputedAroundObstacle) {
+    WorldInformation world;
+    world.setRadius(0.08f);
+    world.setBoundary(-3, -4.5, 3, 4.5);
+    world.setOutOfFieldObstaclePriority(50);
+    world.setRobotId(0);
+    world.addCircle(0, 0, 0.5f, "center", 50);
+    world.collectObstacles();
+    world.collectMovingObstacles();
+
+    PathDebug debug;
+    RNG rng(1);
+    StandardSampler sampler(&rng, world, debug);
+
+    const TrajectoryInput input = constructInput(Vector(0, -2), Vector(0, 2));
+    ASSERT_TRUE(sampler.compute(input));
+
+    const auto &result = sampler.getResult();
+    ASSERT_EQ(result.size(), 2u);
+    Vector offset = input.s0;
+    float timeOffset = 0;
+    for (const auto &info : result) {
+        ASSERT_TRUE(info.profile.isValid());
+        ASSERT_FALSE(world.isTrajectoryInObstacle(info.profile, timeOffset, offset));
+        offset += info.profile.endPos();
+        timeOffset += info.profile.time();
+    }
+    ASSERT_LE(offset.distance(input.s1), 0.05f);
+}
@@ -0,0 +1,110 @@
+/***************************************************************************
+ *   Copyright 2021                                                        *
+ *   Robotics Erlangen e.V.                                                *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "gtest/gtest.h"
+#include "path/trajectorypath.h"
+
+#include <memory>
+
+static void setupWorld(TrajectoryPath &path, int robotId)
+{
+    path.world().setRadius(0.09f);
+    path.world().setBoundary(-3, -4.5, 3, 4.5);
+    path.world().setOutOfFieldObstaclePriority(50);
+    path.world().setRobotId(robotId);
+    path.world().addCircle(0, 0, 0.5f, "center circle", 60);
+}
+
+// the batch must give the same trajectories as planning the robots one after another
+TEST(TrajectoryPath, BatchMatchesSequential) {
+    const int ROBOTS = 6;
+    std::vector<std::unique_ptr<TrajectoryPath>> sequential, batch;
+    for (int i = 0;i<ROBOTS;i++) {
+        sequential.emplace_back(new TrajectoryPath(i + 1, nullptr, pathfinding::None));
+        batch.emplace_back(new TrajectoryPath(i + 1, nullptr, pathfinding::None));
+        setupWorld(*sequential.back(), i);
+        setupWorld(*batch.back(), i);
+    }
+
+    // robots cross the center, every odd robot avoids its predecessor
+    std::vector<TrajectoryPath::BatchInput> inputs;
+    for (int i = 0;i<ROBOTS;i++) {
+        TrajectoryPath::BatchInput input;
+        input.path = batch[i].get();
+        input.s0 = Vector(-2 + 0.8f * i, -2);
+        input.v0 = Vector(0, 0.5f);
+        input.s1 = Vector(2 - 0.8f * i, 2);
+        input.v1 = Vector(0, 0);
+        input.maxSpeed = 3;
+        input.acceleration = 3;
+        if (i % 2 == 1) {
+            input.avoid.push_back({i - 1, 40, 0.09f});
+        }
+        inputs.push_back(input);
+    }
+
+    std::vector<std::vector<TrajectoryPoint>> expected;
+    for (int i = 0;i<ROBOTS;i++) {
+        const auto &input = inputs[i];
+        for (const auto &avoid : input.avoid) {
+            sequential[i]->world().addFriendlyRobotTrajectoryObstacle(sequential[avoid.input]->getCurrentTrajectory(),
+                                                                      avoid.prio, avoid.radius);
+        }
+        expected.push_back(sequential[i]->calculateTrajectory(input.s0, input.v0, input.s1, input.v1,
+                                                              input.maxSpeed, input.acceleration));
+    }
+
+    auto trajectories = TrajectoryPath::calculateTrajectories(inputs);
+
+    ASSERT_EQ(trajectories.size(), expected.size());
+    for (int i = 0;i<ROBOTS;i++) {
+        ASSERT_FALSE(trajectories[i].empty());
+        ASSERT_EQ(trajectories[i].size(), expected[i].size());
+        for (std::size_t j = 0;j<expected[i].size();j++) {
+            ASSERT_EQ(trajectories[i][j].pos, expected[i][j].pos);
+            ASSERT_EQ(trajectories[i][j].speed, expected[i][j].speed);
+            ASSERT_EQ(trajectories[i][j].time, expected[i][j].time);
+        }
+        // the sampled trajectory is used as obstacle by the following robots
+        const auto &current = *batch[i]->getCurrentTrajectory();
+        const auto &expectedCurrent = *sequential[i]->getCurrentTrajectory();
+        ASSERT_EQ(current.size(), expectedCurrent.size());
+        for (std::size_t j = 0;j<current.size();j++) {
+            ASSERT_EQ(current[j].pos, expectedCurrent[j].pos);
+        }
+    }
+}
+
+// planning enlarges the obstacles by the robot radius, this must not accumulate for kept obstacles
+TEST(TrajectoryPath, KeptObstaclesAreNotEnlargedTwice) {
+    TrajectoryPath path(1, nullptr, pathfinding::None);
+    setupWorld(path, 0);
+    for (int i = 0;i<2;i++) {
+        const auto trajectory = path.calculateTrajectory(Vector(-1, 0), Vector(0, 0), Vector(1, 0), Vector(0, 0), 3, 3);
+        ASSERT_FALSE(trajectory.empty());
+    }
+    // robot radius 0.09 around the circle with radius 0.5
+    ASSERT_TRUE(path.world().isInStaticObstacle(Vector(0.58f, 0)));
+    ASSERT_FALSE(path.world().isInStaticObstacle(Vector(0.6f, 0)));
+
+    path.world().collectObstacles();
+    ASSERT_TRUE(path.world().isInStaticObstacle(Vector(0.49f, 0)));
+    ASSERT_FALSE(path.world().isInStaticObstacle(Vector(0.51f, 0)));
+}
@@ -0,0 +1,127 @@
+/***************************************************************************
+ *   Copyright 2021                                                        *
+ *   Robotics Erlangen e.V.                                                *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "gtest/gtest.h"
+#include "path/worldinformation.h"
+
+#include <memory>
+
+static void setupWorld(WorldInformation &world)
+{
+    world.setRadius(0.09f);
+    world.setBoundary(-7, -5, 7, 5);
+}
+
+TEST(WorldInformation, UpdateObstacleHandles) {
+    WorldInformation world;
+    setupWorld(world);
+    const int circle = world.addCircle(1, 1, 0.2f, "opponent", 50);
+    const int rect = world.addRect(-2, -2, -1, -1, "zone", 50, 0);
+    world.collectObstacles();
+    ASSERT_TRUE(world.isInStaticObstacle(Vector(1, 1)));
+    ASSERT_TRUE(world.isInStaticObstacle(Vector(-1.5f, -1.5f)));
+
+    ASSERT_TRUE(world.updateCircle(circle, 3, 3, 0.2f));
+    ASSERT_TRUE(world.updateRect(rect, 2, -2, 3, -1, 0));
+    ASSERT_FALSE(world.updateCircle(circle + 1, 0, 0, 1));
+    ASSERT_FALSE(world.updateRect(-1, 0, 0, 1, 1, 0));
+    world.collectObstacles();
+    ASSERT_FALSE(world.isInStaticObstacle(Vector(1, 1)));
+    ASSERT_TRUE(world.isInStaticObstacle(Vector(3, 3)));
+    ASSERT_FALSE(world.isInStaticObstacle(Vector(-1.5f, -1.5f)));
+    ASSERT_TRUE(world.isInStaticObstacle(Vector(2.5f, -1.5f)));
+    ASSERT_EQ(world.obstacles()[0]->obstacleName(), QByteArray("opponent"));
+}
+
+TEST(WorldInformation, SharedStaticObstacles) {
+    auto shared = std::make_shared<WorldInformation>();
+    shared->addRect(-7, -1, -6, 1, "defense area", 50, 0);
+    shared->addLine(0, -5, 0, 5, 0.01f, "half way", 50);
+
+    auto world = std::make_shared<WorldInformation>();
+    setupWorld(*world);
+    world->addCircle(3, 0, 0.2f, "ball", 50);
+    world->addObstacleSet(shared);
+    world->addObstacleSet(shared);
+    world->addObstacleSet(world);
+    world->collectObstacles();
+
+    ASSERT_EQ(world->obstacles().size(), 3);
+    ASSERT_TRUE(world->isInStaticObstacle(Vector(-6.5f, 0)));
+    ASSERT_TRUE(world->isInStaticObstacle(Vector(0, 2)));
+    ASSERT_TRUE(world->isInStaticObstacle(Vector(3, 0)));
+    ASSERT_FALSE(world->isInStaticObstacle(Vector(2, 2)));
+
+    world->removeObstacleSet(shared);
+    world->collectObstacles();
+    ASSERT_EQ(world->obstacles().size(), 1);
+    ASSERT_FALSE(world->isInStaticObstacle(Vector(-6.5f, 0)));
+
+    world->addObstacleSet(shared);
+    world->clearObstacles();
+    world->collectObstacles();
+    ASSERT_EQ(world->obstacles().size(), 0);
+}
+
+// the own obstacles are kept and moved by their handles, while the shared set is rebuilt every frame
+TEST(WorldInformation, KeepHandlesRefreshSet) {
+    auto shared = std::make_shared<WorldInformation>();
+    WorldInformation world;
+    setupWorld(world);
+    const int opponent = world.addCircle(0, 0, 0.2f, "opponent", 50);
+    world.addObstacleSet(shared);
+
+    for (int frame = 0;frame<5;frame++) {
+        shared->clearObstacles();
+        shared->addRect(frame, 2, frame + 0.5f, 3, "moving zone", 50, 0);
+        ASSERT_TRUE(world.updateCircle(opponent, frame, -2, 0.2f));
+        world.clearMovingObstacles();
+        world.collectObstacles(world.radius());
+
+        ASSERT_EQ(world.obstacles().size(), 2);
+        ASSERT_TRUE(world.isInStaticObstacle(Vector(frame + 0.25f, 2.5f)));
+        ASSERT_TRUE(world.isInStaticObstacle(Vector(frame, -2)));
+        // enlarged by the robot radius exactly once
+        ASSERT_TRUE(world.isInStaticObstacle(Vector(frame + 0.28f, -2)));
+        ASSERT_FALSE(world.isInStaticObstacle(Vector(frame + 0.3f, -2)));
+        if (frame > 0) {
+            ASSERT_FALSE(world.isInStaticObstacle(Vector(frame - 0.75f, 2.5f)));
+            ASSERT_FALSE(world.isInStaticObstacle(Vector(frame - 1, -2)));
+        }
+    }
+}
+
+TEST(WorldInformation, ObstacleArraysOwnTriangles) {
+    WorldInformation copy;
+    {
+        WorldInformation world;
+        setupWorld(world);
+        world.addTriangle(0, 0, 1, 0, 0, 1, 0, "corner", 50);
+        world.collectObstacles();
+        copy = world;
+        // may move the triangles of the original world
+        for (int i = 0;i<100;i++) {
+            world.addTriangle(5, 0, 6, 0, 5, 1, 0, "far away", 50);
+        }
+        ASSERT_TRUE(world.isInStaticObstacle(Vector(0.2f, 0.2f)));
+    }
+    ASSERT_TRUE(copy.isInStaticObstacle(Vector(0.2f, 0.2f)));
+    ASSERT_FALSE(copy.isInStaticObstacle(Vector(2, 2)));
+}
@@ -0,0 +1,56 @@
+/***************************************************************************
+ *   Copyright 2021                                                        *
+ *   Robotics Erlangen e.V.                                                *
+ *   http://www.robotics-erlangen.de/                                      *
+ *   info@robotics-erlangen.de                                             *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   any later version.                                                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "gtest/gtest.h"
+#include "core/parallelfor.h"
+
+#include <QAtomicInt>
+#include <QThreadPool>
+#include <vector>
+
+TEST(ParallelFor, EveryIndexOnce) {
+    const int count = 1000;
+    std::vector<int> visited(count, 0);
+    parallelFor(count, [&visited](int i) {
+        visited[i]++;
+    });
+    for (int i = 0; i < count; i++) {
+        ASSERT_EQ(visited[i], 1);
+    }
+}
+
+TEST(ParallelFor, Empty) {
+    int calls = 0;
+    parallelFor(0, [&calls](int) { calls++; });
+    ASSERT_EQ(calls, 0);
+}
+
+TEST(ParallelFor, Nested) {
+    // nesting must not deadlock, even if the pool is too small to run all tasks at once
+    QThreadPool pool;
+    pool.setMaxThreadCount(2);
+    QAtomicInt counter;
+    parallelFor(8, [&counter, &pool](int) {
+        parallelFor(8, [&counter](int) {
+            counter.fetchAndAddRelaxed(1);
+        }, &pool);
+    }, &pool);
+    ASSERT_EQ(counter.load(), 64);
+}
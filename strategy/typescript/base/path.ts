@@ -71,11 +71,17 @@ interface TriangleObstacle extends Obstacle {
 	lineWidth: number;
 }
 
+// just some impossible to create type, is actually a C++ external
+type ObstacleSetHandle = number & {_tag: "Obstacle set"};
+
 interface PathObjectCommon {
 	destroy(): void;
 	/** Resets path planner object. Clears obstacles and waypoints. Field boundaries won't be changed */
 	reset(): void;
+	/** Removes all obstacles including the obstacle sets, this invalidates the obstacle handles */
 	clearObstacles(): void;
+	/** Only removes the static obstacles added to this path, this invalidates the obstacle handles */
+	clearStaticObstacles?(): void;
 	/**
 	 * Sets field boundaries.
 	 * The two points span up a rectangle whose borders are used as field boundaries. The boundaries must be specified in global coordinates.
@@ -98,8 +104,9 @@ interface PathObjectCommon {
 	 * @param radius - circle radius
 	 * @param name - name of the obstacle
 	 * @param priority - priority of the obstacle
+	 * @returns handle for updateCircle, valid until the obstacles are cleared
 	 */
-	addCircle(x: number, y: number, radius: number, name: string | undefined, priority: number): void;
+	addCircle(x: number, y: number, radius: number, name: string | undefined, priority: number): number;
 	/**
 	 * Adds a line as an obstacle.
 	 * The line MUST be passed in strategy coordinates!
@@ -123,9 +130,10 @@ interface PathObjectCommon {
 	 * @param name - name of the obstacle
 	 * @param priority - obstacle priority
 	 * @param radius - an extra radius around the rectangle to count as obstacle
+	 * @returns handle for updateRect, valid until the obstacles are cleared
 	 */
 	addRect(start_x: number, start_y: number, end_x: number, end_y: number,
-		name: string | undefined, priority: number, radius: number): void;
+		name: string | undefined, priority: number, radius: number): number;
 	/**
 	 * Adds a triangle as an obstacle.
 	 * The triangle MUST be passed in strategy coordinates!
@@ -141,11 +149,36 @@ interface PathObjectCommon {
 	 */
 	addTriangle(x1: number, y1: number, x2: number, y2: number, x3: number, y3: number,
 		lineWidth: number, name: string | undefined, priority: number): void;
+	/** Moves or resizes a circle in place, name and priority are kept */
+	updateCircle?(handle: number, x: number, y: number, radius: number): void;
+	/** Moves or resizes a rectangle in place, name and priority are kept */
+	updateRect?(handle: number, start_x: number, start_y: number, end_x: number, end_y: number, radius: number): void;
+	/**
+	 * References the obstacles of an obstacle set, later changes to the set are used by the path.
+	 * Adding a set twice has no effect, the set is removed by removeObstacleSet or clearObstacles.
+	 */
+	addObstacleSet?(set: ObstacleSetHandle): void;
+	removeObstacleSet?(set: ObstacleSetHandle): void;
 
 	/** Seeds the random number generator used for the path finding */
 	seedRandom(seed: number): void;
 }
 
+/** Static obstacles that are shared by several paths, uses the same coordinates as the paths */
+interface ObstacleSetObject {
+	clearObstacles(): void;
+	addCircle(x: number, y: number, radius: number, name: string | undefined, priority: number): number;
+	addLine(start_x: number, start_y: number, end_x: number, end_y: number,
+		radius: number, name: string | undefined, priority: number): void;
+	addRect(start_x: number, start_y: number, end_x: number, end_y: number,
+		name: string | undefined, priority: number, radius: number): number;
+	addTriangle(x1: number, y1: number, x2: number, y2: number, x3: number, y3: number,
+		lineWidth: number, name: string | undefined, priority: number): void;
+	updateCircle(handle: number, x: number, y: number, radius: number): void;
+	updateRect(handle: number, start_x: number, start_y: number, end_x: number, end_y: number, radius: number): void;
+	getHandle(): ObstacleSetHandle;
+}
+
 /**
  * Waypoints and corridor widths for the way to a waypoint
  *
@@ -202,6 +235,15 @@ type TrajectoryPathResult = {
 
 // just some impossible to create type, is actually a C++ external
 type TrajectoryObstacle = number & {_tag: "Trajectory obstacle"};
+// same as above
+type TrajectoryBatchHandle = number & {_tag: "Trajectory batch handle"};
+
+/**
+ * [batchHandle, startX, startY, startSpeedX, startSpeedY, endX, endY, endSpeedX, endSpeedY, maxSpeed, acceleration, avoid]
+ * avoid is an optional list of [requestIndex, priority, radius] of earlier requests of the same batch
+ */
+type TrajectoryBatchRequest = [TrajectoryBatchHandle, number, number, number, number, number, number, number, number,
+	number, number, [number, number, number][]?];
 
 interface PathObjectTrajectory extends PathObjectCommon {
 	calculateTrajectory(startX: number, startY: number, startSpeedX: number, startSpeedY: number,
@@ -220,6 +262,10 @@ interface PathObjectTrajectory extends PathObjectCommon {
 	addRobotTrajectoryObstacle(obstacle: TrajectoryObstacle, priority: number, radius: number): void;
 	maxIntersectingObstaclePrio(): number;
 	setRobotId?(id: number): void;
+	/** Identifies this path in AmunPath.calculateTrajectories */
+	getBatchHandle?(): TrajectoryBatchHandle;
+	/** Removes the moving obstacles and robot trajectory obstacles, the static obstacles are kept */
+	clearMovingObstacles?(): void;
 }
 
 interface AmunPath {
@@ -227,10 +273,42 @@ interface AmunPath {
 	createPath(): PathObjectRRT;
 	/** Create a new trajectory path planner object */
 	createTrajectoryPath(): PathObjectTrajectory;
+	/**
+	 * Plans the trajectories of several paths concurrently, every path may only be used once per batch.
+	 * Uses global coordinates, the results are in the same order as the requests
+	 */
+	calculateTrajectories?(requests: TrajectoryBatchRequest[]): TrajectoryPathResult[];
+	/** Create a new set of static obstacles that can be added to several path planner objects */
+	createObstacleSet?(): ObstacleSetObject;
+}
+
+// the static obstacles currently added to a path, together with their handles
+interface AddedObstacles {
+	circles: CircleObstacle[];
+	circleHandles: number[];
+	rects: RectObstacle[];
+	rectHandles: number[];
+	lines: LineObstacle[];
+	triangles: TriangleObstacle[];
+}
+
+export type Trajectory = { pos: Position, speed: Speed, time: number }[];
+
+export interface TrajectoryRequest {
+	path: Path;
+	startPos: Position;
+	startSpeed: Speed;
+	endPos: Position;
+	endSpeed: Speed;
+	maxSpeed: number;
+	acceleration: number;
+	/** the trajectories of these earlier requests are added as friendly robot obstacles */
+	avoid?: { request: number, prio: number, radius: number }[];
 }
 
 declare var path: any;
 let pathLocal: any = path;
+const amunPath: AmunPath = pathLocal;
 
 path = undefined;
 
@@ -242,6 +320,32 @@ export function getOriginalPath(): any {
 	return pathLocal;
 }
 
+function sameNameAndPrio(a: Obstacle, b: Obstacle): boolean {
+	return a.name === b.name && a.prio === b.prio;
+}
+
+function sameObstacles<T extends Obstacle>(a: T[], b: T[]): boolean {
+	if (a.length !== b.length) {
+		return false;
+	}
+	for (let i = 0; i < a.length; i++) {
+		for (let key in a[i]) {
+			if (a[i][key] !== b[i][key]) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+function toTrajectory(t: TrajectoryPathResult): Trajectory {
+	let result: Trajectory = [];
+	for (let p of t) {
+		result.push({ pos: new Vector(p.px, p.py), speed: new Vector(p.vx, p.vy), time: p.time});
+	}
+	return result;
+}
+
 export class Path {
 	private readonly _inst: PathObjectRRT;
 	private readonly _trajectoryInst: PathObjectTrajectory;
@@ -251,6 +355,9 @@ export class Path {
 	private lineObstacles: LineObstacle[] = [];
 	private rectObstacles: RectObstacle[] = [];
 	private triangleObstacles: TriangleObstacle[] = [];
+	private obstacleSets: ObstacleSet[] = [];
+	// only set while the static obstacles of the trajectory path are kept between frames
+	private keptTrajectoryObstacles: AddedObstacles | undefined;
 
 	private lastWasTrajectoryPath: boolean = false;
 
@@ -272,16 +379,43 @@ export class Path {
 		this._trajectoryInst.seedRandom(seed);
 	}
 
-	private addObstaclesToPath(path: PathObjectCommon) {
+	// with kept, the obstacles already added to the path are updated in place if possible
+	private addObstaclesToPath(path: PathObjectCommon, kept?: AddedObstacles) {
+		if (path.addObstacleSet) {
+			for (let set of this.obstacleSets) {
+				path.addObstacleSet(set.handle);
+			}
+		}
+		if (kept) {
+			if (this.updateKeptObstacles(path, kept)) {
+				return;
+			}
+			path.clearStaticObstacles!();
+			kept.circles = [];
+			kept.circleHandles = [];
+			kept.rects = [];
+			kept.rectHandles = [];
+			kept.lines = this.lineObstacles.slice();
+			kept.triangles = this.triangleObstacles.slice();
+		}
+
 		for (let circle of this.circleObstacles) {
-			path.addCircle(circle.x, circle.y, circle.radius, circle.name, circle.prio);
+			let handle = path.addCircle(circle.x, circle.y, circle.radius, circle.name, circle.prio);
+			if (kept) {
+				kept.circles.push(circle);
+				kept.circleHandles.push(handle);
+			}
 		}
 		for (let line of this.lineObstacles) {
 			path.addLine(line.start_x, line.start_y, line.stop_x, line.stop_y,
 				line.radius, line.name, line.prio);
 		}
 		for (let rect of this.rectObstacles) {
-			path.addRect(rect.start_x, rect.start_y, rect.stop_x, rect.stop_y, rect.name, rect.prio, rect.radius);
+			let handle = path.addRect(rect.start_x, rect.start_y, rect.stop_x, rect.stop_y, rect.name, rect.prio, rect.radius);
+			if (kept) {
+				kept.rects.push(rect);
+				kept.rectHandles.push(handle);
+			}
 		}
 		for (let tri of this.triangleObstacles) {
 			path.addTriangle(tri.x1, tri.y1, tri.x2, tri.y2, tri.x3, tri.y3, tri.lineWidth,
@@ -289,6 +423,87 @@ export class Path {
 		}
 	}
 
+	// moves the kept circles and rectangles to the current ones and adds the new ones
+	// returns false if obstacles would have to be removed or lines, triangles, names or priorities changed
+	private updateKeptObstacles(path: PathObjectCommon, kept: AddedObstacles): boolean {
+		if (this.circleObstacles.length < kept.circles.length || this.rectObstacles.length < kept.rects.length ||
+				!sameObstacles(this.lineObstacles, kept.lines) || !sameObstacles(this.triangleObstacles, kept.triangles)) {
+			return false;
+		}
+		for (let i = 0; i < kept.circles.length; i++) {
+			if (!sameNameAndPrio(this.circleObstacles[i], kept.circles[i])) {
+				return false;
+			}
+		}
+		for (let i = 0; i < kept.rects.length; i++) {
+			if (!sameNameAndPrio(this.rectObstacles[i], kept.rects[i])) {
+				return false;
+			}
+		}
+
+		for (let i = 0; i < this.circleObstacles.length; i++) {
+			let circle = this.circleObstacles[i];
+			if (i < kept.circleHandles.length) {
+				path.updateCircle!(kept.circleHandles[i], circle.x, circle.y, circle.radius);
+				kept.circles[i] = circle;
+			} else {
+				kept.circleHandles.push(path.addCircle(circle.x, circle.y, circle.radius, circle.name, circle.prio));
+				kept.circles.push(circle);
+			}
+		}
+		for (let i = 0; i < this.rectObstacles.length; i++) {
+			let rect = this.rectObstacles[i];
+			if (i < kept.rectHandles.length) {
+				path.updateRect!(kept.rectHandles[i], rect.start_x, rect.start_y, rect.stop_x, rect.stop_y, rect.radius);
+				kept.rects[i] = rect;
+			} else {
+				kept.rectHandles.push(path.addRect(rect.start_x, rect.start_y, rect.stop_x, rect.stop_y, rect.name, rect.prio, rect.radius));
+				kept.rects.push(rect);
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Keeps the static obstacles of the trajectory path between frames and moves them in place using their handles.
+	 * They are only added again if obstacles were removed, lines or triangles changed
+	 * or circles and rectangles changed their name or priority.
+	 * Has no effect if ra does not support it.
+	 */
+	setKeepObstacles(keep: boolean) {
+		let inst = this._trajectoryInst;
+		let supported = inst.updateCircle != undefined && inst.updateRect != undefined &&
+			inst.clearStaticObstacles != undefined && inst.clearMovingObstacles != undefined;
+		if (keep && supported && !this.keptTrajectoryObstacles) {
+			// the path might already contain static obstacles of this frame
+			inst.clearStaticObstacles!();
+			this.keptTrajectoryObstacles = { circles: [], circleHandles: [], rects: [], rectHandles: [], lines: [], triangles: [] };
+		} else if (!keep && this.keptTrajectoryObstacles) {
+			inst.clearStaticObstacles!();
+			this.keptTrajectoryObstacles = undefined;
+		}
+	}
+
+	/**
+	 * Adds the obstacles of the set to both path planners, later changes to the set are used as well.
+	 * The set stays added until removeObstacleSet is called, clearObstacles does not remove it.
+	 */
+	addObstacleSet(set: ObstacleSet) {
+		if (!this.obstacleSets.includes(set)) {
+			this.obstacleSets.push(set);
+		}
+	}
+
+	removeObstacleSet(set: ObstacleSet) {
+		let index = this.obstacleSets.indexOf(set);
+		if (index === -1) {
+			return;
+		}
+		this.obstacleSets.splice(index, 1);
+		this._inst.removeObstacleSet!(set.handle);
+		this._trajectoryInst.removeObstacleSet!(set.handle);
+	}
+
 	private getObstacleString() {
 		let teamLetter = "y";
 		if (teamIsBlue) {
@@ -297,16 +512,47 @@ export class Path {
 		return `obstacles: ${this._robotId}${teamLetter}`;
 	}
 
-	getTrajectory(startPos: Position, startSpeed: Speed, endPos: Position, endSpeed: Speed, maxSpeed: number, acceleration: number): { pos: Position, speed: Speed, time: number}[] {
+	private prepareTrajectoryPath() {
 		this.lastWasTrajectoryPath = true;
-		this.addObstaclesToPath(this._trajectoryInst);
+		this.addObstaclesToPath(this._trajectoryInst, this.keptTrajectoryObstacles);
+	}
+
+	getTrajectory(startPos: Position, startSpeed: Speed, endPos: Position, endSpeed: Speed, maxSpeed: number, acceleration: number): Trajectory {
+		this.prepareTrajectoryPath();
 		let t = this._trajectoryInst.calculateTrajectory(startPos.x, startPos.y, startSpeed.x,
 			startSpeed.y, endPos.x, endPos.y, endSpeed.x, endSpeed.y, maxSpeed, acceleration);
-		let result: { pos: Position, speed: Speed, time: number }[] = [];
-		for (let p of t) {
-			result.push({ pos: new Vector(p.px, p.py), speed: new Vector(p.vx, p.vy), time: p.time});
+		return toTrajectory(t);
+	}
+
+	/**
+	 * Plans the trajectories of several robots at once, the robots are planned concurrently if ra supports it.
+	 * Every path may only be used once and a request can only avoid the trajectories of earlier requests.
+	 * The results are in the same order as the requests, all positions and speeds are in global coordinates.
+	 */
+	static getTrajectories(requests: TrajectoryRequest[]): Trajectory[] {
+		if (amunPath.calculateTrajectories == undefined || requests.some((r) => r.path._trajectoryInst.getBatchHandle == undefined)) {
+			// plan one after another on older ra versions
+			let results: Trajectory[] = [];
+			for (let r of requests) {
+				for (let a of r.avoid || []) {
+					r.path._trajectoryInst.addRobotTrajectoryObstacle(requests[a.request].path._trajectoryInst.getTrajectoryAsObstacle(), a.prio, a.radius);
+				}
+				results.push(r.path.getTrajectory(r.startPos, r.startSpeed, r.endPos, r.endSpeed, r.maxSpeed, r.acceleration));
+			}
+			return results;
 		}
-		return result;
+
+		let batch: TrajectoryBatchRequest[] = [];
+		for (let r of requests) {
+			r.path.prepareTrajectoryPath();
+			let avoid: [number, number, number][] = [];
+			for (let a of r.avoid || []) {
+				avoid.push([a.request, a.prio, a.radius]);
+			}
+			batch.push([r.path._trajectoryInst.getBatchHandle!(), r.startPos.x, r.startPos.y, r.startSpeed.x, r.startSpeed.y,
+				r.endPos.x, r.endPos.y, r.endSpeed.x, r.endSpeed.y, r.maxSpeed, r.acceleration, avoid]);
+		}
+		return amunPath.calculateTrajectories(batch).map(toTrajectory);
 	}
 
 	getPath(x1: number, y1: number, x2: number, y2: number): Waypoint[] {
@@ -330,7 +576,12 @@ export class Path {
 
 	clearObstacles() {
 		this._inst.clearObstacles();
-		this._trajectoryInst.clearObstacles();
+		if (this.keptTrajectoryObstacles) {
+			// the static obstacles are updated by the next trajectory calculation
+			this._trajectoryInst.clearMovingObstacles!();
+		} else {
+			this._trajectoryInst.clearObstacles();
+		}
 		this.circleObstacles.length = 0;
 		this.lineObstacles.length = 0;
 		this.rectObstacles.length = 0;
@@ -509,3 +760,84 @@ export class Path {
 	}
 }
 
+/**
+ * Static obstacles shared by several paths, e.g. the field boundaries and defense areas.
+ * The obstacles are given in strategy coordinates like for Path, see Path.addObstacleSet
+ */
+export class ObstacleSet {
+	private readonly _inst: ObstacleSetObject;
+	readonly handle: ObstacleSetHandle;
+
+	constructor() {
+		if (amunPath.createObstacleSet == undefined) {
+			throw new Error("Obstacle sets are not supported by this ra version");
+		}
+		this._inst = amunPath.createObstacleSet();
+		this.handle = this._inst.getHandle();
+	}
+
+	clearObstacles() {
+		this._inst.clearObstacles();
+	}
+
+	/** @returns handle for updateCircle, valid until the obstacles are cleared */
+	addCircle(x: number, y: number, radius: number, name?: string, prio: number = 0): number {
+		if (teamIsBlue) {
+			x = -x;
+			y = -y;
+		}
+		return this._inst.addCircle(x, y, radius, isPerformanceMode ? undefined : name, prio);
+	}
+
+	updateCircle(handle: number, x: number, y: number, radius: number) {
+		if (teamIsBlue) {
+			x = -x;
+			y = -y;
+		}
+		this._inst.updateCircle(handle, x, y, radius);
+	}
+
+	addLine(start_x: number, start_y: number, stop_x: number, stop_y: number, radius: number, name?: string, prio: number = 0) {
+		if (teamIsBlue) {
+			start_x = -start_x;
+			start_y = -start_y;
+			stop_x = -stop_x;
+			stop_y = -stop_y;
+		}
+		this._inst.addLine(start_x, start_y, stop_x, stop_y, radius, isPerformanceMode ? undefined : name, prio);
+	}
+
+	/** @returns handle for updateRect, valid until the obstacles are cleared */
+	addRect(start_x: number, start_y: number, stop_x: number, stop_y: number, radius: number, name?: string, prio: number = 0): number {
+		if (teamIsBlue) {
+			start_x = -start_x;
+			start_y = -start_y;
+			stop_x = -stop_x;
+			stop_y = -stop_y;
+		}
+		return this._inst.addRect(start_x, start_y, stop_x, stop_y, isPerformanceMode ? undefined : name, prio, radius);
+	}
+
+	updateRect(handle: number, start_x: number, start_y: number, stop_x: number, stop_y: number, radius: number) {
+		if (teamIsBlue) {
+			start_x = -start_x;
+			start_y = -start_y;
+			stop_x = -stop_x;
+			stop_y = -stop_y;
+		}
+		this._inst.updateRect(handle, start_x, start_y, stop_x, stop_y, radius);
+	}
+
+	addTriangle(x1: number, y1: number, x2: number, y2: number, x3: number, y3: number,
+			lineWidth: number, name?: string, prio: number = 0) {
+		if (teamIsBlue) {
+			x1 = -x1;
+			y1 = -y1;
+			x2 = -x2;
+			y2 = -y2;
+			x3 = -x3;
+			y3 = -y3;
+		}
+		this._inst.addTriangle(x1, y1, x2, y2, x3, y3, lineWidth, isPerformanceMode ? undefined : name, prio);
+	}
+}